@@ -15,20 +15,27 @@ delay_vsync_LD= -nostdlib
 delay_vsync_objects= \
 	../../build/delay_vsync/obj/boot/Init-RAMonly.o \
 	../../build/delay_vsync/obj/common/Uart1.o \
-	../../build/delay_vsync/obj/common/Timer.o \
+	../../build/delay_vsync/obj/common/Itc.o \
+	../../build/delay_vsync/obj/common/Itc_asm.o \
+	../../build/delay_vsync/obj/common/DelayLine.o \
+	../../build/delay_vsync/obj/common/Tmr.o \
+	../../build/delay_vsync/obj/common/Time.o \
+	../../build/delay_vsync/obj/common/RoscCal.o \
+	../../build/delay_vsync/obj/common/Keypad.o \
 	../../build/delay_vsync/obj/app/delay_vsync.o \
 
 
 ../../build/delay_vsync/obj/%.o: ../../src/%.s $(register_files)
 	mkdir -p $(@D)
-	$(CC) -c $(delay_vsync_CC) -o $@ $(delay_vsync_INC) $<
+	$(CC) -c $(delay_vsync_CC) $(OPT_CC) -o $@ $(delay_vsync_INC) $<
 
 ../../build/delay_vsync/obj/%.o: ../../src/%.c $(register_files)
 	mkdir -p $(@D)
-	$(CC) -c $(delay_vsync_CC) -o $@ $(delay_vsync_INC) $<
+	$(CC) -c $(delay_vsync_CC) $(OPT_CC) -o $@ $(delay_vsync_INC) $<
 
 ../../build/delay_vsync/delay_vsync.elf: $(delay_vsync_objects)
-	$(LD) $(delay_vsync_LD) -Map $(@:.elf=.map) -o $@ $+ -T ../../scripts/ld/RAMonly.lds
+	$(LD) $(delay_vsync_LD) $(OPT_LD) -Map $(@:.elf=.map) -o $@ $+ -T ../../scripts/ld/RAMonly.lds
+	$(SIZECHECK) $(@:.elf=.map) || (rm -f $@; false)
 
 ../../build/delay_vsync/image_flash.bin ../../build/delay_vsync/image_ram.bin: ../../build/delay_vsync/delay_vsync.elf
 	@$(BUILDIMAGES) -o $(dir $<)image $<
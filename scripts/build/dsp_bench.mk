@@ -0,0 +1,54 @@
+# append the name of the local application to the targets
+TARGETS+=dsp_bench
+
+# local build options
+dsp_bench_CC= -O3 -g3 -Wall -fno-common -msoft-float \
+          -mcpu=arm7tdmi-s -march=armv4t -mtune=arm7tdmi-s \
+          -std=c99
+dsp_bench_INC= \
+	-I ../../src/compiler/gnuarm \
+	-I ../../src/build/registers \
+	-I ../../src
+dsp_bench_LD= -nostdlib
+
+# list of the objects needed to link dsp_bench
+dsp_bench_objects= \
+	../../build/dsp_bench/obj/boot/Init-RAMonly.o \
+	../../build/dsp_bench/obj/common/Uart1.o \
+	../../build/dsp_bench/obj/common/Itc.o \
+	../../build/dsp_bench/obj/common/Itc_asm.o \
+	../../build/dsp_bench/obj/common/Tmr.o \
+	../../build/dsp_bench/obj/common/Clock.o \
+	../../build/dsp_bench/obj/common/Dsp.o \
+	../../build/dsp_bench/obj/common/Bits.o \
+	../../build/dsp_bench/obj/app/dsp_bench.o \
+
+
+../../build/dsp_bench/obj/%.o: ../../src/%.s $(register_files)
+	mkdir -p $(@D)
+	$(CC) -c $(dsp_bench_CC) $(OPT_CC) -o $@ $(dsp_bench_INC) $<
+
+../../build/dsp_bench/obj/%.o: ../../src/%.c $(register_files)
+	mkdir -p $(@D)
+	$(CC) -c $(dsp_bench_CC) $(OPT_CC) -o $@ $(dsp_bench_INC) $<
+
+../../build/dsp_bench/dsp_bench.elf: $(dsp_bench_objects)
+	$(LD) $(dsp_bench_LD) $(OPT_LD) -Map $(@:.elf=.map) -o $@ $+ -T ../../scripts/ld/RAMonly.lds
+	$(SIZECHECK) $(@:.elf=.map) || (rm -f $@; false)
+
+../../build/dsp_bench/image_flash.bin ../../build/dsp_bench/image_ram.bin: ../../build/dsp_bench/dsp_bench.elf
+	@$(BUILDIMAGES) -o $(dir $<)image $<
+
+.PHONY: dsp_bench dsp_bench_clean dsp_bench_install dsp_bench_flash
+.SILENT: dsp_bench dsp_bench_clean dsp_bench_install dsp_bench_flash
+dsp_bench: ../../build/dsp_bench/dsp_bench.elf
+	echo "... Finished building dsp_bench ..."
+
+dsp_bench_install: ../../build/dsp_bench/image_ram.bin
+	$(LOAD) $(LOAD_FLAGS) $+
+
+dsp_bench_flash: ../../build/flasher_2_1/image_ram.bin ../../build/dsp_bench/image_flash.bin
+	$(LOAD) $(LOAD_FLAGS) $+
+
+dsp_bench_clean:
+	rm -rf ../../build/dsp_bench
\ No newline at end of file
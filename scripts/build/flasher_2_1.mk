@@ -19,19 +19,23 @@ flasher_2_1_objects= \
 	../../build/flasher_2_1/obj/boot/Init-RAMROM.o \
 	../../build/flasher_2_1/obj/common/Uart1.o \
 	../../build/flasher_2_1/obj/common/Flash.o \
+	../../build/flasher_2_1/obj/common/Crc.o \
+	../../build/flasher_2_1/obj/common/Timer.o \
+	../../build/flasher_2_1/obj/common/Tmr.o \
 	../../build/flasher_2_1/obj/app/flasher.o
 
 ../../build/flasher_2_1/obj/%.o: ../../src/%.s $(register_files)
 	mkdir -p $(@D)
-	$(CC) -c $(FLASH_2_1_CC) -o $@ $(FLASH_2_1_INC) $<
+	$(CC) -c $(FLASH_2_1_CC) $(OPT_CC) -o $@ $(FLASH_2_1_INC) $<
 
 ../../build/flasher_2_1/obj/%.o: ../../src/%.c $(register_files)
 	mkdir -p $(@D)
-	$(CC) -c $(FLASH_2_1_CC) -o $@ $(FLASH_2_1_INC) $<
+	$(CC) -c $(FLASH_2_1_CC) $(OPT_CC) -o $@ $(FLASH_2_1_INC) $<
 
 
 ../../build/flasher_2_1/flasher_2_1.elf: $(flasher_2_1_objects)
-	$(LD) $(FLASH_2_1_LD) -Map $(@:.elf=.map) -o $@ $+ $(FLASH_2_1_LIBS) -T ../../scripts/ld/RAMROM.lds
+	$(LD) $(FLASH_2_1_LD) $(OPT_LD) -Map $(@:.elf=.map) -o $@ $+ $(FLASH_2_1_LIBS) -T ../../scripts/ld/RAMROM.lds
+	$(SIZECHECK) $(@:.elf=.map) || (rm -f $@; false)
 
 ../../build/flasher_2_1/image_flash.bin ../../build/flasher_2_1/image_ram.bin: ../../build/flasher_2_1/flasher_2_1.elf
 	@$(BUILDIMAGES) -o $(dir $<)image $<
@@ -15,20 +15,27 @@ gen_pattern_LD= -nostdlib
 gen_pattern_objects= \
 	../../build/gen_pattern/obj/boot/Init-RAMonly.o \
 	../../build/gen_pattern/obj/common/Uart1.o \
-	../../build/gen_pattern/obj/common/Timer.o \
+	../../build/gen_pattern/obj/common/Itc.o \
+	../../build/gen_pattern/obj/common/Itc_asm.o \
+	../../build/gen_pattern/obj/common/Wave.o \
+	../../build/gen_pattern/obj/common/Tmr.o \
+	../../build/gen_pattern/obj/common/Time.o \
+	../../build/gen_pattern/obj/common/RoscCal.o \
+	../../build/gen_pattern/obj/common/Keypad.o \
 	../../build/gen_pattern/obj/app/gen_pattern.o \
 
 
 ../../build/gen_pattern/obj/%.o: ../../src/%.s $(register_files)
 	mkdir -p $(@D)
-	$(CC) -c $(gen_pattern_CC) -o $@ $(gen_pattern_INC) $<
+	$(CC) -c $(gen_pattern_CC) $(OPT_CC) -o $@ $(gen_pattern_INC) $<
 
 ../../build/gen_pattern/obj/%.o: ../../src/%.c $(register_files)
 	mkdir -p $(@D)
-	$(CC) -c $(gen_pattern_CC) -o $@ $(gen_pattern_INC) $<
+	$(CC) -c $(gen_pattern_CC) $(OPT_CC) -o $@ $(gen_pattern_INC) $<
 
 ../../build/gen_pattern/gen_pattern.elf: $(gen_pattern_objects)
-	$(LD) $(gen_pattern_LD) -Map $(@:.elf=.map) -o $@ $+ -T ../../scripts/ld/RAMonly.lds
+	$(LD) $(gen_pattern_LD) $(OPT_LD) -Map $(@:.elf=.map) -o $@ $+ -T ../../scripts/ld/RAMonly.lds
+	$(SIZECHECK) $(@:.elf=.map) || (rm -f $@; false)
 
 ../../build/gen_pattern/image_flash.bin ../../build/gen_pattern/image_ram.bin: ../../build/gen_pattern/gen_pattern.elf
 	@$(BUILDIMAGES) -o $(dir $<)image $<
@@ -1,34 +1,45 @@
 # append the name of the local application to the targets
 TARGETS+=rosc_tune
 
-# local build options
-rosc_tune_CC= -O3 -g3 -Wall -fno-common -msoft-float \
+# local build options, the ROM 2.1 library gives the NVM driver to the persistent store:
+# + ARM mode for the 64 bits time conversions (no UMULL in Thumb), the linker adds the
+#   interworking veneers to the Thumb functions of the ROM
+# + r8 is reserved to the ROM as in the flasher
+# + the ROM interrupt handlers and dispatch table (ITC_Interface.h) replace Itc.c
+rosc_tune_CC= -O3 -g3 -Wall -fno-common -ffixed-r8 -msoft-float \
           -mcpu=arm7tdmi-s -march=armv4t -mtune=arm7tdmi-s \
-          -std=c99
+          -mthumb-interwork -std=c99
 rosc_tune_INC= \
+	-I ../../src/interface/ROM_2_1 \
+	-I ../../src/common \
 	-I ../../src/compiler/gnuarm \
 	-I ../../src/build/registers \
 	-I ../../src
-rosc_tune_LD= -nostdlib
+rosc_tune_LD= -nostartfiles -nostdlib -static
+rosc_tune_LIBS=../../libraries/LLC_2_1.a
 
 # list of the objects needed to link rosc_tune
 rosc_tune_objects= \
-	../../build/rosc_tune/obj/boot/Init-RAMonly.o \
+	../../build/rosc_tune/obj/boot/Init-RAMROM.o \
 	../../build/rosc_tune/obj/common/Uart1.o \
-	../../build/rosc_tune/obj/common/Timer.o \
+	../../build/rosc_tune/obj/common/Time.o \
+	../../build/rosc_tune/obj/common/RoscCal.o \
+	../../build/rosc_tune/obj/common/Flash.o \
+	../../build/rosc_tune/obj/common/KvStore.o \
 	../../build/rosc_tune/obj/app/rosc_tune.o \
 
 
 ../../build/rosc_tune/obj/%.o: ../../src/%.s $(register_files)
 	mkdir -p $(@D)
-	$(CC) -c $(rosc_tune_CC) -o $@ $(rosc_tune_INC) $<
+	$(CC) -c $(rosc_tune_CC) $(OPT_CC) -o $@ $(rosc_tune_INC) $<
 
 ../../build/rosc_tune/obj/%.o: ../../src/%.c $(register_files)
 	mkdir -p $(@D)
-	$(CC) -c $(rosc_tune_CC) -o $@ $(rosc_tune_INC) $<
+	$(CC) -c $(rosc_tune_CC) $(OPT_CC) -o $@ $(rosc_tune_INC) $<
 
 ../../build/rosc_tune/rosc_tune.elf: $(rosc_tune_objects)
-	$(LD) $(rosc_tune_LD) -Map $(@:.elf=.map) -o $@ $+ -T ../../scripts/ld/RAMonly.lds
+	$(LD) $(rosc_tune_LD) $(OPT_LD) -Map $(@:.elf=.map) -o $@ $+ $(rosc_tune_LIBS) -T ../../scripts/ld/RAMROM.lds
+	$(SIZECHECK) $(@:.elf=.map) || (rm -f $@; false)
 
 ../../build/rosc_tune/image_flash.bin ../../build/rosc_tune/image_ram.bin: ../../build/rosc_tune/rosc_tune.elf
 	@$(BUILDIMAGES) -o $(dir $<)image $<
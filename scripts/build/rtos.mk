@@ -13,10 +13,26 @@ rtos_LD= -nostdlib
 
 # list of the objects needed to link rtos
 ifneq ($(AC), 1)
+# measure the time spent with the interrupts disabled (make INT_DEBUG=1)
+ifeq ($(INT_DEBUG), 1)
+rtos_CC+= -DPROC_INT_DEBUG
+endif
+
 rtos_objects= \
 	../../build/rtos/obj/boot/Init-RAMonly.o \
 	../../build/rtos/obj/common/Uart1.o \
+	../../build/rtos/obj/common/Itc.o \
+	../../build/rtos/obj/common/Itc_asm.o \
 	../../build/rtos/obj/common/Timer.o \
+	../../build/rtos/obj/common/Tmr.o \
+	../../build/rtos/obj/common/Clock.o \
+	../../build/rtos/obj/common/Time.o \
+	../../build/rtos/obj/common/RoscCal.o \
+	../../build/rtos/obj/common/Adc.o \
+	../../build/rtos/obj/common/Keypad.o \
+	../../build/rtos/obj/common/Bits.o \
+	../../build/rtos/obj/common/IsrProf.o \
+	../../build/rtos/obj/proc/proc.o \
 	../../build/rtos/obj/rtos/rtos_asm.o \
 	../../build/rtos/obj/rtos/rtos.o \
 	../../build/rtos/obj/app/rtos_test.o
@@ -24,6 +40,8 @@ else
 rtos_objects= \
 	../../build/rtos/obj/boot/Init-RAMonly.o \
 	../../build/rtos/obj/common/Uart1.o \
+	../../build/rtos/obj/common/Itc.o \
+	../../build/rtos/obj/common/Itc_asm.o \
 	../../build/rtos/obj/rtos_ac/switch.o \
 	../../build/rtos/obj/rtos_ac/rtos_ac.o \
 	../../build/rtos/obj/rtos_ac/test.o
@@ -32,14 +50,15 @@ endif
 
 ../../build/rtos/obj/%.o: ../../src/%.s $(register_files)
 	mkdir -p $(@D)
-	$(CC) -c $(rtos_CC) -o $@ $(rtos_INC) $<
+	$(CC) -c $(rtos_CC) $(OPT_CC) -o $@ $(rtos_INC) $<
 
 ../../build/rtos/obj/%.o: ../../src/%.c $(register_files)
 	mkdir -p $(@D)
-	$(CC) -c $(rtos_CC) -o $@ $(rtos_INC) $<
+	$(CC) -c $(rtos_CC) $(OPT_CC) -o $@ $(rtos_INC) $<
 
 ../../build/rtos/rtos.elf: $(rtos_objects)
-	$(LD) $(rtos_LD) -Map $(@:.elf=.map) -o $@ $+ -T ../../scripts/ld/RAMonly.lds
+	$(LD) $(rtos_LD) $(OPT_LD) -Map $(@:.elf=.map) -o $@ $+ -T ../../scripts/ld/RAMonly.lds
+	$(SIZECHECK) $(@:.elf=.map) || (rm -f $@; false)
 
 ../../build/rtos/image_flash.bin ../../build/rtos/image_ram.bin: ../../build/rtos/rtos.elf
 	@$(BUILDIMAGES) -o $(dir $<)image $<
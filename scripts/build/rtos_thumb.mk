@@ -0,0 +1,98 @@
+# append the name of the local application to the targets
+TARGETS+=rtos_thumb
+
+# local build options, the same application as rtos with a mixed ARM/Thumb profile:
+# + the exception handlers, the interrupt handlers, the scheduler and the assembly in
+#   ARM mode (rtos_thumb_ARM), for the speed
+# + the 64 bits time conversions (Clock and rtos_test) in ARM mode too: Thumb-1 has no
+#   UMULL, their multiplications would need the libgcc __aeabi_lmul
+# + the rest in Thumb mode optimized for size, without jump tables which would need
+#   the libgcc helpers
+rtos_thumb_CC= -g3 -Wall -fno-common -msoft-float \
+          -mcpu=arm7tdmi-s -march=armv4t -mtune=arm7tdmi-s \
+          -mthumb-interwork -std=c99
+rtos_thumb_ARM_CC= -marm -O3
+rtos_thumb_THUMB_CC= -mthumb -Os -fno-jump-tables
+rtos_thumb_INC= \
+	-I ../../src/compiler/gnuarm \
+	-I ../../src/build/registers \
+	-I ../../src
+rtos_thumb_LD= -nostdlib
+
+# measure the time spent with the interrupts disabled (make INT_DEBUG=1)
+ifeq ($(INT_DEBUG), 1)
+rtos_thumb_CC+= -DPROC_INT_DEBUG
+endif
+
+# list of the objects built in ARM mode
+rtos_thumb_ARM= \
+	../../build/rtos_thumb/obj/boot/Init-RAMonly.o \
+	../../build/rtos_thumb/obj/common/Itc.o \
+	../../build/rtos_thumb/obj/common/Itc_asm.o \
+	../../build/rtos_thumb/obj/common/Timer.o \
+	../../build/rtos_thumb/obj/common/Tmr.o \
+	../../build/rtos_thumb/obj/common/Clock.o \
+	../../build/rtos_thumb/obj/common/Adc.o \
+	../../build/rtos_thumb/obj/common/Keypad.o \
+	../../build/rtos_thumb/obj/common/IsrProf.o \
+	../../build/rtos_thumb/obj/proc/proc.o \
+	../../build/rtos_thumb/obj/rtos/rtos_asm.o \
+	../../build/rtos_thumb/obj/rtos/rtos.o \
+	../../build/rtos_thumb/obj/app/rtos_test.o
+
+# list of the objects needed to link rtos_thumb
+rtos_thumb_objects= \
+	../../build/rtos_thumb/obj/boot/Init-RAMonly.o \
+	../../build/rtos_thumb/obj/common/Uart1.o \
+	../../build/rtos_thumb/obj/common/Itc.o \
+	../../build/rtos_thumb/obj/common/Itc_asm.o \
+	../../build/rtos_thumb/obj/common/Timer.o \
+	../../build/rtos_thumb/obj/common/Tmr.o \
+	../../build/rtos_thumb/obj/common/Clock.o \
+	../../build/rtos_thumb/obj/common/Time.o \
+	../../build/rtos_thumb/obj/common/RoscCal.o \
+	../../build/rtos_thumb/obj/common/Adc.o \
+	../../build/rtos_thumb/obj/common/Keypad.o \
+	../../build/rtos_thumb/obj/common/Bits.o \
+	../../build/rtos_thumb/obj/common/IsrProf.o \
+	../../build/rtos_thumb/obj/proc/proc.o \
+	../../build/rtos_thumb/obj/rtos/rtos_asm.o \
+	../../build/rtos_thumb/obj/rtos/rtos.o \
+	../../build/rtos_thumb/obj/app/rtos_test.o
+
+# select the instruction set of an object
+rtos_thumb_ISA=$(if $(filter $(1),$(rtos_thumb_ARM)),$(rtos_thumb_ARM_CC),$(rtos_thumb_THUMB_CC))
+
+../../build/rtos_thumb/obj/%.o: ../../src/%.s $(register_files)
+	mkdir -p $(@D)
+	$(CC) -c $(rtos_thumb_CC) $(OPT_CC) $(rtos_thumb_ARM_CC) -o $@ $(rtos_thumb_INC) $<
+
+../../build/rtos_thumb/obj/%.o: ../../src/%.c $(register_files)
+	mkdir -p $(@D)
+	$(CC) -c $(rtos_thumb_CC) $(OPT_CC) $(call rtos_thumb_ISA,$@) -o $@ $(rtos_thumb_INC) $<
+
+../../build/rtos_thumb/rtos_thumb.elf: $(rtos_thumb_objects)
+	$(LD) $(rtos_thumb_LD) $(OPT_LD) -Map $(@:.elf=.map) -o $@ $+ -T ../../scripts/ld/RAMonly.lds
+	$(SIZECHECK) $(@:.elf=.map) || (rm -f $@; false)
+
+../../build/rtos_thumb/image_flash.bin ../../build/rtos_thumb/image_ram.bin: ../../build/rtos_thumb/rtos_thumb.elf
+	@$(BUILDIMAGES) -o $(dir $<)image $<
+
+.PHONY: rtos_thumb rtos_thumb_clean rtos_thumb_install rtos_thumb_flash rtos_thumb_compare
+.SILENT: rtos_thumb rtos_thumb_clean rtos_thumb_install rtos_thumb_flash
+rtos_thumb: ../../build/rtos_thumb/rtos_thumb.elf
+	echo "... Finished building rtos_thumb ..."
+
+rtos_thumb_install: ../../build/rtos_thumb/image_ram.bin
+	$(LOAD) $(LOAD_FLAGS) $+
+
+rtos_thumb_flash: ../../build/flasher_2_1/image_ram.bin ../../build/rtos_thumb/image_flash.bin
+	$(LOAD) $(LOAD_FLAGS) $+
+
+# compare the footprint with the ARM only build, the speed is given by the 'p' command
+# of both images (interrupt handlers profile)
+rtos_thumb_compare: rtos rtos_thumb
+	$(MAPSIZE) -d EXEC_RAM_TEXT ../../build/rtos/rtos.map ../../build/rtos_thumb/rtos_thumb.map
+
+rtos_thumb_clean:
+	rm -rf ../../build/rtos_thumb
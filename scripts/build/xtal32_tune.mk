@@ -1,34 +1,45 @@
 # append the name of the local application to the targets
 TARGETS+=xtal32_tune
 
-# local build options
-xtal32_tune_CC= -O3 -g3 -Wall -fno-common -msoft-float \
+# local build options, the ROM 2.1 library gives the NVM driver to the persistent store:
+# + ARM mode for the 64 bits time conversions (no UMULL in Thumb), the linker adds the
+#   interworking veneers to the Thumb functions of the ROM
+# + r8 is reserved to the ROM as in the flasher
+# + the ROM interrupt handlers and dispatch table (ITC_Interface.h) replace Itc.c
+xtal32_tune_CC= -O3 -g3 -Wall -fno-common -ffixed-r8 -msoft-float \
           -mcpu=arm7tdmi-s -march=armv4t -mtune=arm7tdmi-s \
-          -std=c99
+          -mthumb-interwork -std=c99
 xtal32_tune_INC= \
+	-I ../../src/interface/ROM_2_1 \
+	-I ../../src/common \
 	-I ../../src/compiler/gnuarm \
 	-I ../../src/build/registers \
 	-I ../../src
-xtal32_tune_LD= -nostdlib
+xtal32_tune_LD= -nostartfiles -nostdlib -static
+xtal32_tune_LIBS=../../libraries/LLC_2_1.a
 
 # list of the objects needed to link xtal32_tune
 xtal32_tune_objects= \
-	../../build/xtal32_tune/obj/boot/Init-RAMonly.o \
+	../../build/xtal32_tune/obj/boot/Init-RAMROM.o \
 	../../build/xtal32_tune/obj/common/Uart1.o \
-	../../build/xtal32_tune/obj/common/Timer.o \
+	../../build/xtal32_tune/obj/common/Time.o \
+	../../build/xtal32_tune/obj/common/XtalDisc.o \
+	../../build/xtal32_tune/obj/common/Flash.o \
+	../../build/xtal32_tune/obj/common/KvStore.o \
 	../../build/xtal32_tune/obj/app/xtal32_tune.o \
 
 
 ../../build/xtal32_tune/obj/%.o: ../../src/%.s $(register_files)
 	mkdir -p $(@D)
-	$(CC) -c $(xtal32_tune_CC) -o $@ $(xtal32_tune_INC) $<
+	$(CC) -c $(xtal32_tune_CC) $(OPT_CC) -o $@ $(xtal32_tune_INC) $<
 
 ../../build/xtal32_tune/obj/%.o: ../../src/%.c $(register_files)
 	mkdir -p $(@D)
-	$(CC) -c $(xtal32_tune_CC) -o $@ $(xtal32_tune_INC) $<
+	$(CC) -c $(xtal32_tune_CC) $(OPT_CC) -o $@ $(xtal32_tune_INC) $<
 
 ../../build/xtal32_tune/xtal32_tune.elf: $(xtal32_tune_objects)
-	$(LD) $(xtal32_tune_LD) -Map $(@:.elf=.map) -o $@ $+ -T ../../scripts/ld/RAMonly.lds
+	$(LD) $(xtal32_tune_LD) $(OPT_LD) -Map $(@:.elf=.map) -o $@ $+ $(xtal32_tune_LIBS) -T ../../scripts/ld/RAMROM.lds
+	$(SIZECHECK) $(@:.elf=.map) || (rm -f $@; false)
 
 ../../build/xtal32_tune/image_flash.bin ../../build/xtal32_tune/image_ram.bin: ../../build/xtal32_tune/xtal32_tune.elf
 	@$(BUILDIMAGES) -o $(dir $<)image $<
@@ -21,67 +21,25 @@
 #include "proc/proc.h"
 
 #include "common/Uart1.h"
+#include "common/Tmr.h"
+#include "common/DelayLine.h"
+#include "common/Keypad.h"
+#include "common/Itc.h"
+#include "common/RoscCal.h"
 
 #include "reg_gpio.h"
 #include "reg_crm.h"
-#include "reg_itc.h"
-#include "reg_tmr0.h"
-#include "reg_tmr1.h"
 #include "reg_adc.h"
 
-// defines necessary for the ITC block
-#define ITC_CRM_INDEX (3)
-
 // use GPIO8 (TMR0) as the VSYNC output
 #define VSYNC_OUT_GPIO (8)
+#define VSYNC_OUT_TMR  (0)
 // use GPIO9 (TMR1) as the VSYNC input
 #define VSYNC_IN_GPIO (9)
+#define VSYNC_IN_TMR  (1)
 
-__FIQ void FiqHandler(void)
-{
-    uint8_t fiq;
-
-    // check were the FIQ is coming from
-    fiq = itc_fivector_getf();
-
-    switch (fiq)
-    {
-    case ITC_CRM_INDEX:
-        fiq = crm_ext_wu_evt_getf();
-        Uart1PutS("CRM FIQ\n");
-
-        if (fiq & 1)
-        {
-            Uart1PutS("PB0\n");
-            gpio_data_set0_set(1 << 23);
-            gpio_data_reset0_set(6 << 23);
-        }
-        if (fiq & 2)
-        {
-            Uart1PutS("PB1\n");
-            gpio_data_set0_set(2 << 23);
-            gpio_data_reset0_set(5 << 23);
-        }
-        if (fiq & 4)
-        {
-            Uart1PutS("PB2\n");
-            gpio_data_set0_set(4 << 23);
-            gpio_data_reset0_set(3 << 23);
-        }
-        if (fiq & 8)
-        {
-            Uart1PutS("PB3\n");
-        }
-
-        // clear any pending interrupt
-        crm_status_set(0xFFFF);
-        break;
-        
-    default:
-        Uart1PutS("Unsupported FIQ\n");
-        break;
-    }
-}
+// minimum ADC change applied to the delay, to filter the ADC noise
+#define VSYNC_ADC_NOISE (10)
 
 /**
  * Set the basic configuration for the whole platform.  This can vary with the
@@ -116,17 +74,15 @@ InitPlatform(void)
     // + direction configuration
     //   * configure the GPIOs 25-23 as output (KBI[3..1]), connected to LED control
     //   * configure the VSYNC out GPIO as output
-    //   * configure the VSYNC in GPIO as output
+    //   * configure the VSYNC in GPIO as input
     gpio_pad_dir_set0_set((7 << 23) | (1 << VSYNC_OUT_GPIO));
     gpio_pad_dir_reset0_set(1 << VSYNC_IN_GPIO);
 
     // + function configuration
     //   * configure the GPIO15-14 to UART1 (UART1 TX and RX)
-    gpio_func_sel0_set((0x01 << (14*2)) | (0x01 << (15*2)));
-    
-    // + data select
-    //   * read the VSYNC IN from the GPIO
-    gpio_data_sel0_set(gpio_data_sel0_get() & (~(1 << VSYNC_IN_GPIO)));
+    //   * configure the VSYNC out and in GPIOs to the TMR output and input
+    gpio_func_sel0_set((0x01 << (14*2)) | (0x01 << (15*2)) |
+            (0x01 << (VSYNC_OUT_GPIO*2)) | (0x01 << (VSYNC_IN_GPIO*2)));
 
     // + pull up configuration
     //   * enable the PU on the GPIO 29-26 (KBI[7..4]), connected to PushButtons
@@ -138,10 +94,12 @@ InitPlatform(void)
     gpio_data0_set(1<<23);
 
     // ITC configuration:
-    // enable CRM and TMR in interrupt controller
-    itc_intenable_setf((1<<ITC_CRM_INDEX));
-    itc_inttype_setf((1<<ITC_CRM_INDEX));
-    
+    // + CRM to IRQ for the push buttons
+    // + TMR to FIQ for the VSYNC, never delayed by the push buttons
+    ItcInit();
+    ItcSet(ITC_SRC_CRM, KeypadInt, ITC_IRQ);
+    ItcSet(ITC_SRC_TMR, TmrInt, ITC_FIQ);
+
     
     // ADC configuration
     // 
@@ -158,77 +116,110 @@ InitPlatform(void)
     adc_mode_set(OVERRIDE_BIT);
     adc_override_pack(0, 1, 0, 5);
 
-    // clear pending interrupts from the CRM after the GPIO PD/PU configuration is stable
+    // the pads settle while the platform initializes, KeypadInit clears the events
+    // their PD/PU configuration caused and the debouncing ignores the later glitches
+}
+
+
+/**
+ * Print the delay accuracy since the previous report.
+ */
+static void
+VsyncReport(void)
+{
+    struct delay_line_stats stats;
+
+    DelayLineStats(&stats);
+
+    Uart1PutS("edges = 0x");
+    Uart1PutU32(stats.edges);
+    Uart1PutS(", late = 0x");
+    Uart1PutU32(stats.late);
+    Uart1PutS(", dropped = 0x");
+    Uart1PutU32(stats.dropped);
+    Uart1PutS("\ndelay min = 0x");
+    Uart1PutU16(stats.min_delay);
+    Uart1PutS(", max = 0x");
+    Uart1PutU16(stats.max_delay);
+    Uart1PutS(", error max = 0x");
+    Uart1PutU16(stats.max_error);
+    Uart1PutC('\n');
+}
+
+/**
+ * Handle a push button press: PB0 to PB2 light a LED, PB3 prints the delay accuracy.
+ * @param[in] key Push button pressed
+ */
+static void
+VsyncKey(uint8_t key)
+{
+    switch (key)
     {
-        volatile uint32_t toto = 0;
-        while (toto++ < 10000) ;
+    case 0:
+        Uart1PutS("PB0\n");
+        gpio_data_set0_set(1 << 23);
+        gpio_data_reset0_set(6 << 23);
+        break;
+
+    case 1:
+        Uart1PutS("PB1\n");
+        gpio_data_set0_set(2 << 23);
+        gpio_data_reset0_set(5 << 23);
+        break;
+
+    case 2:
+        Uart1PutS("PB2\n");
+        gpio_data_set0_set(4 << 23);
+        gpio_data_reset0_set(3 << 23);
+        break;
+
+    case 3:
+        Uart1PutS("PB3\n");
+        VsyncReport();
+        break;
     }
-    crm_status_set(0xFFFF);
 }
 
-
 void Main(void)
 {
-    uint32_t value, prev_value, state;
-    uint16_t adc, prev_adc;
-    
+    struct keypad_event key;
+    uint16_t adc, delay;
+
     // initialize the whole platform
     InitPlatform();
 
     // initialize the UART1
     Uart1Init();
 
+    // measure the ring oscillator with its trims for the debounce times, and wait for
+    // the push buttons
+    RoscCalApply(11, 24);
+    KeypadInit(NULL);
+
+    // reproduce the VSYNC in edges on the VSYNC out, counting the peripheral clock
+    // divided by 128, with the delay given by the ADC
+    delay = adc_ad1_result_get();
+    DelayLineStart(VSYNC_IN_TMR, VSYNC_OUT_TMR, TMR_SRC_CLK_DIV(7), delay);
+
     // release the interrupts
     PROC_INT_START();
 
-    // configure timer 0:
-    //    - count rising edges
-    //    - primary source = peripheral clock divide by 128 (0xf)
-    //    - count repeatedly
-    //    - count up
-    //    - no co_init and no OFLAG
-    tmr0_ctrl_pack(1, 0xf, 0, 0, 0, 0, 0, 0);
-    tmr0_sctrl_set(0);
-    tmr0_csctrl_set(0);
-
     while (1)
     {
-        // reinit the TMR0 counter
-        state = 0;
+        // follow the ADC
+        adc = adc_ad1_result_get();
+        if (((adc - delay) > VSYNC_ADC_NOISE) || ((delay - adc) > VSYNC_ADC_NOISE))
+        {
+            delay = adc;
+            DelayLineSet(delay);
+            Uart1PutS("delay = 0x");
+            Uart1PutU16(delay);
+            Uart1PutC('\n');
+        }
 
-        do
+        if (KeypadGet(&key) && (key.type == KEYPAD_PRESS))
         {
-            // read the value of TIMER1
-            value = gpio_data0_get() & (1 << VSYNC_IN_GPIO);
-            
-            if (prev_value != value)
-            {
-                adc = adc_ad1_result_get();
-                
-#if 0
-                if (((adc - prev_adc) > 10) || ((prev_adc - adc) > 10)) 
-                {
-                    prev_adc = adc;
-                    Uart1PutS("ADC = ");
-                    Uart1PutU16(adc);
-                    Uart1PutC('\n');
-                }
-#endif
-                tmr0_cntr_set(0);
-                while (tmr0_cntr_get() < adc);
-
-                prev_value = value;
-                if (value)
-                {
-                    gpio_data_set0_set(1 << VSYNC_OUT_GPIO);
-                }
-                else
-                {
-                    gpio_data_reset0_set(1 << VSYNC_OUT_GPIO);
-                }
-            }
-
-        } while (state == 0);
+            VsyncKey(key.key);
+        }
     }
 }
-
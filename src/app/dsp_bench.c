@@ -0,0 +1,242 @@
+/*
+ * Benchmark of the fixed-point signal processing blocks and of the bit utilities.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "proc/proc.h"
+
+#include "common/Uart1.h"
+#include "common/Clock.h"
+#include "common/Dsp.h"
+#include "common/Bits.h"
+#include "common/Itc.h"
+#include "common/Time.h"
+
+#include "reg_gpio.h"
+#include "reg_crm.h"
+
+// number of samples processed by each block (log2)
+#define BENCH_LOG2 (8)
+#define BENCH_SIZE (1 << BENCH_LOG2)
+
+// 16 taps low pass FIR, cut-off at 0.1 of the sampling rate (Hamming window)
+static q15_t const bench_fir[16] =
+{
+    -114, -159, -139, 291, 1450, 3284, 5246, 6524,
+    6524, 5246, 3284, 1450, 291, -139, -159, -114
+};
+
+// low pass biquad, cut-off at 0.1 of the sampling rate, Q = 0.707 (Q14)
+#define BENCH_BIQUAD 1105, 2210, 1105, -18727, 6763
+
+static q15_t bench_in[BENCH_SIZE];
+static q15_t bench_out[BENCH_SIZE];
+static q15_t bench_state[2 * 16];
+static q15_t bench_window[64];
+static struct dsp_complex bench_fft[1 << DSP_FFT_LOG2_MAX];
+static uint32_t bench_bits[BENCH_SIZE];
+
+/// Measure a bit utility over the bench_bits values, the loop is measured without one
+#define BENCH_BITS(__name, __op)                                            \
+do {                                                                        \
+    uint32_t __l_sum = 0, __l_i, __l_start = ClockGet32();                  \
+    for (__l_i = 0; __l_i < BENCH_SIZE; __l_i++)                            \
+    {                                                                       \
+        __l_sum += __op(bench_bits[__l_i]);                                 \
+    }                                                                       \
+    PrintBench(__name, ClockGet32() - __l_start, (q15_t const *) &__l_sum, 2); \
+} while(0)
+
+
+/**
+ * Set the basic configuration for the whole platform.  This can vary with the
+ * application.
+ */
+static void
+InitPlatform(void)
+{
+    // CRM configuration:
+    // + system configuration
+    //   * the clock frequency for the whole platform to 24MHz (divider = 0)
+    //   * JTAG security enforced off
+    //   * SPIF uses 1.8
+    //   * power source is VBATT
+    crm_sys_cntl_pack(0, 0, 1, 1, 0, 0);
+
+    // + wakeup configuration
+    //   + enable WU pads and interrupts
+    //   + configure edge detection on low transition
+    crm_wu_cntl_set((crm_wu_cntl_get() & ~EXT_WU_POL_MASK) |
+            EXT_WU_IEN_MASK | EXT_WU_EN_MASK | EXT_WU_EDGE_MASK);
+
+    // + ring oscillator configuration
+    //   + tune the 2kHz oscillator (coarse=11, fine=24, dependent on every chip)
+    crm_ringosc_cntl_pack(11, 24, 1);
+
+    // + status configuration
+    //   * clear any pending interrupt
+    crm_status_set(0xFFFF);
+
+    // GPIO configuration:
+    // + direction configuration
+    //   * configure the GPIOs 25-23 as output (KBI3-KBI1), connect to LED control
+    gpio_pad_dir0_set(7 << 23);
+
+    // + function configuration
+    //   * configure the GPIO15-14 to UART1 (UART1 TX and RX)
+    gpio_func_sel0_set((0x01 << (14*2)) | (0x01 << (15*2)));
+
+    // + pull up configuration
+    //   * enable the PU on the KBI[7..4] pads
+    gpio_pad_pu_en0_set(gpio_pad_pu_en0_get() | (0xF<<26));
+    gpio_pad_pu_sel0_set(gpio_pad_pu_sel0_get() | (0xF<<26));
+
+    // + init data configuration
+    //   * clear the LEDs
+    gpio_data0_set(0);
+
+    // ITC configuration:
+    // + disable all interrupts in interrupt controller
+    ItcInit();
+
+    // clear pending interrupts from the CRM after the GPIO PD/PU configuration is stable
+    TimeWaitUntil(TimeGet() + TimeMsToTicksUp(TIME_PADS_SETTLE_MS));
+    crm_status_set(0xFFFF);
+}
+
+/**
+ * Print the result of a block.
+ *
+ * The checksum of the output samples allows to compare the results with a reference.
+ * @param[in] name Name of the block
+ * @param[in] cycles Number of cycles taken by the block for BENCH_SIZE samples
+ * @param[in] out Output samples
+ * @param[in] n Number of output samples
+ */
+static void
+PrintBench(char const *name, uint32_t cycles, q15_t const *out, uint32_t n)
+{
+    uint32_t sum = 0;
+
+    while (n--)
+    {
+        sum = (sum << 1 | sum >> 31) + (uint16_t) *out++;
+    }
+
+    Uart1PutS("\n");
+    Uart1PutS(name);
+    Uart1PutS(": cycles/sample = ");
+    Uart1PutU32(cycles >> BENCH_LOG2);
+    Uart1PutS(", checksum = ");
+    Uart1PutU32(sum);
+}
+
+void Main(void)
+{
+    struct dsp_fir fir;
+    struct dsp_biquad bq[2];
+    struct dsp_rms rms;
+    struct dsp_stats stats;
+    uint32_t start, n, i, j, seed = 1;
+
+    // initialize the whole platform
+    InitPlatform();
+
+    // initialize the UART1
+    Uart1Init();
+
+    // the clock counts the CPU cycles (24MHz)
+    if (!ClockInit())
+    {
+        Uart1PutS("\nClock init failed: TMR2 or TMR3 in use");
+        while (1) ;
+    }
+
+    // input: square wave plus noise
+    for (i = 0; i < BENCH_SIZE; i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        bench_in[i] = ((i & 16) ? 8192 : -8192) + (((int32_t) seed) >> 19);
+    }
+
+    Uart1PutS("\nDSP benchmark, samples = ");
+    Uart1PutU32(BENCH_SIZE);
+
+    DspFirInit(&fir, bench_fir, bench_state, 16);
+    start = ClockGet32();
+    n = DspFir(&fir, bench_in, bench_out, BENCH_SIZE, 1);
+    PrintBench("FIR 16 taps", ClockGet32() - start, bench_out, n);
+
+    DspFirInit(&fir, bench_fir, bench_state, 16);
+    start = ClockGet32();
+    n = DspFir(&fir, bench_in, bench_out, BENCH_SIZE, 4);
+    PrintBench("FIR 16 taps, decimation 4", ClockGet32() - start, bench_out, n);
+
+    DspBiquadInit(&bq[0], BENCH_BIQUAD);
+    DspBiquadInit(&bq[1], BENCH_BIQUAD);
+    start = ClockGet32();
+    DspBiquad(bq, 2, bench_in, bench_out, BENCH_SIZE);
+    PrintBench("IIR 2 biquads", ClockGet32() - start, bench_out, BENCH_SIZE);
+
+    DspRmsInit(&rms, bench_window, 6);
+    start = ClockGet32();
+    for (i = 0; i < BENCH_SIZE; i++)
+    {
+        bench_out[i] = DspRms(&rms, bench_in[i]);
+    }
+    PrintBench("RMS 64 samples", ClockGet32() - start, bench_out, BENCH_SIZE);
+
+    start = ClockGet32();
+    DspStats(bench_in, BENCH_LOG2, &stats);
+    PrintBench("min/max/mean", ClockGet32() - start, (q15_t const *) &stats, 3);
+
+    // the FFTs cover the samples with 64 points transforms
+    start = ClockGet32();
+    for (i = 0; i < BENCH_SIZE; i += (1 << DSP_FFT_LOG2_MAX))
+    {
+        for (j = 0; j < (1 << DSP_FFT_LOG2_MAX); j++)
+        {
+            bench_fft[j].re = bench_in[i + j];
+            bench_fft[j].im = 0;
+        }
+        DspFft(bench_fft, DSP_FFT_LOG2_MAX);
+    }
+    PrintBench("FFT 64 points", ClockGet32() - start, (q15_t const *) bench_fft,
+            2 << DSP_FFT_LOG2_MAX);
+
+    // bit utilities over values with all the counts of leading zeros, never 0
+    for (i = 0; i < BENCH_SIZE; i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        bench_bits[i] = (seed >> (seed >> 27)) | 1;
+    }
+
+    BENCH_BITS("loop", );
+    BENCH_BITS("CLZ sequence", BitsClzSeq);
+    BENCH_BITS("CLZ table", BitsClzTable);
+    BENCH_BITS("CLZ C", BitsClzC);
+#ifdef BITS_HAVE_CLZ
+    BENCH_BITS("CLZ native", BitsClzNative);
+#endif
+    BENCH_BITS("FFS", BitsFfs);
+    BENCH_BITS("popcount", BitsPopcount);
+    BENCH_BITS("bit reverse", BitsRev32);
+
+    Uart1PutS("\nDSP benchmark done");
+    while (1) ;
+}
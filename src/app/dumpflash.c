@@ -18,12 +18,173 @@
  */
 
 #include "Flash.h"
+#include "Crc.h"
+#include "FlashCache.h"
+#include "Overlay.h"
 #include "Uart1.h"
 #include "NVM.h"
 
 #include "reg_gpio.h"
 #include "reg_crm.h"
 
+/// Size of the blocks read from the NVM and sent on the UART in binary mode
+#define DUMP_BLOCK_SIZE (1024)
+
+/// Size of the NVM reads, the UART TX FIFO is refilled between two reads
+#define DUMP_STEP_SIZE  (64)
+
+/// Size of the dumped internal flash, the restricted last sector cannot be read
+#define DUMP_NVM_SIZE   FLASH_CACHE_READ_END
+
+/// Overlay of the flash content print, only run once at startup (the header print is
+/// the resident fallback)
+#define DUMP_OVL_PRINT  0
+
+/// Blocks of the binary dump: one is sent while the next one is read
+static uint32_t dump_block[2][DUMP_BLOCK_SIZE / 4];
+
+/**
+ * Read a 32 bits little endian value from the UART.
+ * @return Value received
+ */
+static uint32_t
+GetU32(void)
+{
+    uint32_t v = 0;
+    int i;
+
+    for (i = 0; i < 32; i += 8)
+    {
+        v |= ((uint32_t)(uint8_t)Uart1GetC()) << i;
+    }
+    return v;
+}
+
+/**
+ * Dump a range of the NVM in binary.
+ *
+ * The range is sent as raw bytes followed by the CRC32 of the range (little endian).
+ * The NVM is read by blocks, and a block is read while the previous one is sent on the
+ * UART.  The block is read by small steps, the UART TX FIFO being refilled in between so
+ * that the line never goes idle.
+ * @param[in] type NVM type as returned by NVM_Detect
+ * @param[in] addr First address of the range
+ * @param[in] len Length of the range
+ * @return gNvmErrNoError_c or the first error returned by NVM_Read (the data that could
+ * not be read is sent as 0xFF)
+ */
+static nvmErr_t
+DumpBinary(nvmType_t type, uint32_t addr, uint32_t len)
+{
+    nvmErr_t err, status = gNvmErrNoError_c;
+    uint32_t crc = CRC32_INIT;
+    uint32_t chunk, offset, step, i;
+    uint8_t trailer[4];
+    uint8_t *p;
+    int cur = 0;
+
+    while (len)
+    {
+        chunk = (len > DUMP_BLOCK_SIZE) ? DUMP_BLOCK_SIZE : len;
+
+        // read the block while the previous one is being sent
+        for (offset = 0; offset < chunk; offset += step)
+        {
+            step = ((chunk - offset) > DUMP_STEP_SIZE) ? DUMP_STEP_SIZE : (chunk - offset);
+            p = ((uint8_t *)dump_block[cur]) + offset;
+
+            Uart1Int();
+            err = NVM_Read(gNvmInternalInterface_c, type, p, addr + offset, step);
+            if (err)
+            {
+                for (i = 0; i < step; i++)
+                {
+                    p[i] = 0xFF;
+                }
+                if (status == gNvmErrNoError_c)
+                {
+                    status = err;
+                }
+            }
+            Uart1Int();
+            crc = Crc32(crc, p, step);
+        }
+
+        // wait for the previous block to be sent, then send this one
+        while (!Uart1WriteDone())
+        {
+            Uart1Int();
+        }
+        Uart1WriteStart(dump_block[cur], chunk);
+
+        addr += chunk;
+        len -= chunk;
+        cur ^= 1;
+    }
+
+    // send the CRC trailer
+    crc ^= 0xFFFFFFFF;
+    for (i = 0; i < 4; i++)
+    {
+        trailer[i] = crc >> (i * 8);
+    }
+    while (!Uart1WriteDone())
+    {
+        Uart1Int();
+    }
+    Uart1WriteStart(trailer, 4);
+    while (!Uart1WriteDone())
+    {
+        Uart1Int();
+    }
+
+    return status;
+}
+
+/**
+ * Print the beginning of the flash and the cache statistics.
+ */
+static void __OVERLAY(DUMP_OVL_PRINT) __NOINLINE
+DumpPrint(void)
+{
+    uint32_t addr, data;
+
+    // print the flash content
+    for (addr = 0x0000; addr < 0x400; addr+=4)
+    {
+        FlashCacheRead(&data, addr, 4);
+        Uart1PutU32(data);
+        Uart1PutS("\n");
+    }
+
+    // print the cache statistics
+    Uart1PutS("Cache hits: 0x");
+    Uart1PutU32(FlashCacheStats()->hits);
+    Uart1PutS(", misses: 0x");
+    Uart1PutU32(FlashCacheStats()->misses);
+    Uart1PutS(", prefetches: 0x");
+    Uart1PutU32(FlashCacheStats()->prefetches);
+    Uart1PutS("\n");
+}
+
+/**
+ * Print the header of the flash image, when the full print is not available because
+ * the flash holds another image (the usual case of an image loaded through the UART).
+ */
+static void
+DumpPrintHeader(void)
+{
+    uint32_t header[2];
+    nvmErr_t err;
+
+    err = FlashCacheRead(header, 0, sizeof(header));
+    Uart1PutS("Flash header: 0x");
+    Uart1PutU32(err ? 0xFFFFFFFF : header[0]);
+    Uart1PutS(", length: 0x");
+    Uart1PutU32(err ? 0xFFFFFFFF : header[1]);
+    Uart1PutS("\n");
+}
+
 /**
  * Set the basic configuration for the whole platform.  This can vary with the
  * application.
@@ -53,7 +214,8 @@ void Main(void)
 {
     nvmType_t type=0;
     nvmErr_t err;
-    uint32_t addr, data;
+    ovlErr_t ovl;
+    uint32_t addr, len;
 
     // initialize the whole platform
     InitPlatform();
@@ -72,16 +234,58 @@ void Main(void)
     Uart1PutU8(type);
     Uart1PutS("\n");
 
+    // read the flash through the cache
+    FlashCacheInit(type);
+
     // magical function call
 //    NVM_SetSVar(0);
 
-    // print the flash content
-    for (addr = 0x0000; addr < 0x400; addr+=4)
+    // the full print is only available when the flash holds this image and its
+    // overlays, else only the flash header is printed by the resident code
+    ovl = OverlayInit(type);
+    if (ovl == OVL_OK)
     {
-        NVM_Read(gNvmInternalInterface_c, type, &data, addr, 4);
-        Uart1PutU32(data);
-        Uart1PutS("\n");
+        ovl = OverlayLoad(DUMP_OVL_PRINT);
+    }
+    Uart1PutS("Overlay load returned: 0x");
+    Uart1PutU8(ovl);
+    Uart1PutS("\n");
+    if (ovl == OVL_OK)
+    {
+        DumpPrint();
+    }
+    else
+    {
+        DumpPrintHeader();
     }
 
-    while (1) ;
+    // serve the binary dump commands: 'b' <addr:u32> <len:u32>
+    while (1)
+    {
+        Uart1PutS("ready...\n");
+        if (Uart1GetC() != 'b')
+        {
+            continue;
+        }
+        addr = GetU32();
+        len = GetU32();
+
+        // clip the range to the readable NVM
+        if (addr > DUMP_NVM_SIZE)
+        {
+            addr = DUMP_NVM_SIZE;
+        }
+        if (len > (DUMP_NVM_SIZE - addr))
+        {
+            len = DUMP_NVM_SIZE - addr;
+        }
+
+        // announce the length actually sent, then the data and the CRC
+        Uart1PutU32(len);
+        Uart1PutS("\n");
+        err = DumpBinary(type, addr, len);
+        Uart1PutS("dump returned: 0x");
+        Uart1PutU8(err);
+        Uart1PutS("\n");
+    }
 }
@@ -18,12 +18,260 @@
  */
 
 #include "Flash.h"
+#include "Crc.h"
 #include "Uart1.h"
 #include "NVM.h"
+#include "KvStore.h"
+#include "Timer.h"
+#include "Interrupt.h"
 
 #include "reg_gpio.h"
 #include "reg_crm.h"
 
+/// Size of the pages received from the UART and written to the NVM
+#define FLASHER_PAGE_SIZE (256)
+
+/// First word of a flash image ("OKOK")
+#define FLASHER_IMAGE_MAGIC  (0x4B4F4B4F)
+
+/// First word of a segment table image ("SEGT", buildimages.py --sparse)
+#define FLASHER_SPARSE_MAGIC (0x54474553)
+
+/// Address of the RAM image
+#define FLASHER_RAM_BASE     (0x400000)
+
+/// End of the flash image, the persistent store follows
+#define FLASHER_IMAGE_END    (KV_SECTOR_FIRST * KV_SECTOR_SIZE)
+
+/// Pages being received and written: one is received while the other one is written
+static uint32_t flasher_page[2][FLASHER_PAGE_SIZE / 4];
+
+/// Zeros written to the gaps between the segments of a segment table image
+static uint32_t const flasher_zero[16];
+
+/// Size of the header of a segment table image (magic, length, entry, number of
+/// segments, number of flash records)
+#define FLASHER_SPARSE_HEADER (5 * 4)
+
+/// Size of a segment record (address, file size, memory size) or flash record (flash
+/// address, size, size)
+#define FLASHER_SPARSE_RECORD (3 * 4)
+
+/// Placement of a segment table image: the records are parsed as they are received,
+/// the data of the segments is written at its offset in the flash image and the gaps
+/// are filled with 0's, then the flash records (the overlays) are written after the
+/// image, so that the flash holds the same image as image_flash.bin
+static struct flasher_sparse
+{
+    /// Header or record being received
+    uint32_t words[FLASHER_SPARSE_HEADER / 4];
+
+    /// Number of bytes of the words received, and expected
+    uint8_t got;
+    uint8_t need;
+
+    /// Number of segments, then of flash records, still expected
+    uint32_t segments;
+    uint32_t records;
+
+    /// Data bytes of the current segment still expected, then padding bytes
+    uint32_t data;
+    uint8_t pad;
+
+    /// Flash address of the next data byte
+    uint32_t dest;
+
+    /// Flash address following the last data written, and following the last segment
+    /// in memory, i.e. the end of the image (the gaps and the zero filled tails are
+    /// written from the first one up to the next segment or flash record)
+    uint32_t written;
+    uint32_t end;
+} flasher_sparse;
+
+/**
+ * Divide two unsigned values (long division, to avoid relying on the division
+ * routine of the ROM).
+ * @param[in] num Numerator
+ * @param[in] den Denominator (non null)
+ * @return Quotient
+ */
+static uint32_t
+Divide(uint32_t num, uint32_t den)
+{
+    uint32_t quot = 0, rem = 0;
+    int i;
+
+    for (i = 31; i >= 0; i--)
+    {
+        rem = (rem << 1) | ((num >> i) & 1);
+        if (rem >= den)
+        {
+            rem -= den;
+            quot |= 1 << i;
+        }
+    }
+    return quot;
+}
+
+/**
+ * Fill a range of the flash with 0's.
+ * @param[in] type NVM type as returned by NVM_Detect
+ * @param[in] from First address
+ * @param[in] to Address following the range
+ * @return The status of NVM_Write
+ */
+static nvmErr_t
+FlasherZero(nvmType_t type, uint32_t from, uint32_t to)
+{
+    nvmErr_t err = gNvmErrNoError_c;
+    uint32_t n;
+
+    for (; !err && (from < to); from += n)
+    {
+        n = ((to - from) > sizeof(flasher_zero)) ? sizeof(flasher_zero) : (to - from);
+        err = NVM_Write(gNvmInternalInterface_c, type, (void *)flasher_zero, from, n);
+    }
+    return err;
+}
+
+/**
+ * Start the placement of a segment table image, the header is expected first.
+ */
+static void
+FlasherSparseStart(void)
+{
+    flasher_sparse.got = 0;
+    flasher_sparse.need = FLASHER_SPARSE_HEADER;
+    flasher_sparse.segments = 0;
+    flasher_sparse.records = 0;
+    flasher_sparse.data = 0;
+    flasher_sparse.pad = 0;
+    flasher_sparse.written = 8;
+    flasher_sparse.end = 8;
+}
+
+/**
+ * Place the received part of a segment table image.
+ * @param[in] type NVM type as returned by NVM_Detect
+ * @param[in] p Bytes received
+ * @param[in] size Number of bytes
+ * @return The status of NVM_Write, gNvmErrAddressSpaceOverflow_c if a segment or a flash
+ * record is not in order or does not fit in the flash image
+ */
+static nvmErr_t
+FlasherSparse(nvmType_t type, uint8_t const *p, uint32_t size)
+{
+    struct flasher_sparse *sp = &flasher_sparse;
+    nvmErr_t err = gNvmErrNoError_c;
+    uint32_t n, start;
+
+    while (size && !err)
+    {
+        // data of the current segment, then its padding to the next word
+        if (sp->data)
+        {
+            n = (size > sp->data) ? sp->data : size;
+            err = NVM_Write(gNvmInternalInterface_c, type, (void *)p, sp->dest, n);
+            sp->dest += n;
+            sp->data -= n;
+            p += n;
+            size -= n;
+            continue;
+        }
+        if (sp->pad)
+        {
+            sp->pad--;
+            p++;
+            size--;
+            continue;
+        }
+
+        // header or record words
+        ((uint8_t *)sp->words)[sp->got++] = *p++;
+        size--;
+        if (sp->got < sp->need)
+        {
+            continue;
+        }
+        sp->got = 0;
+        if (sp->need == FLASHER_SPARSE_HEADER)
+        {
+            sp->segments = sp->words[3];
+            sp->records = sp->words[4];
+            sp->need = FLASHER_SPARSE_RECORD;
+            continue;
+        }
+
+        if (sp->segments)
+        {
+            // a segment: after the previous one and inside the flash image
+            start = 8 + sp->words[0] - FLASHER_RAM_BASE;
+            if ((sp->words[0] < FLASHER_RAM_BASE) || (start < sp->end) ||
+                (start > FLASHER_IMAGE_END) || (sp->words[2] < sp->words[1]) ||
+                (sp->words[2] > (FLASHER_IMAGE_END - start)))
+            {
+                return gNvmErrAddressSpaceOverflow_c;
+            }
+            sp->segments--;
+            sp->end = start + sp->words[2];
+        }
+        else
+        {
+            // a flash record: after the image and the previous record, inside the flash
+            // image area
+            start = sp->words[0];
+            if (!sp->records || (start < sp->end) || (start < sp->written) ||
+                (start > FLASHER_IMAGE_END) || (sp->words[2] != sp->words[1]) ||
+                (sp->words[1] > (FLASHER_IMAGE_END - start)))
+            {
+                return gNvmErrAddressSpaceOverflow_c;
+            }
+            sp->records--;
+        }
+
+        // fill the gap with the previous one, including its zero filled tail
+        err = FlasherZero(type, sp->written, start);
+        sp->dest = start;
+        sp->data = sp->words[1];
+        sp->pad = -sp->words[1] & 3;
+        sp->written = start + sp->words[1];
+    }
+
+    return err;
+}
+
+/**
+ * Complete the placement of a segment table image: the tail of the last segment is
+ * filled with 0's, unless flash records followed, and the flash image header is
+ * written, its length not including the flash records.
+ * @param[in] type NVM type as returned by NVM_Detect
+ * @return The status of NVM_Write, gNvmErrAddressSpaceOverflow_c if the image is
+ * truncated
+ */
+static nvmErr_t
+FlasherSparseEnd(nvmType_t type)
+{
+    struct flasher_sparse *sp = &flasher_sparse;
+    nvmErr_t err;
+
+    if (sp->segments || sp->records || sp->data || sp->pad || sp->got ||
+        (sp->need != FLASHER_SPARSE_RECORD))
+    {
+        return gNvmErrAddressSpaceOverflow_c;
+    }
+
+    err = FlasherZero(type, sp->written, sp->end);
+    if (err)
+    {
+        return err;
+    }
+
+    // the header last, the ROM does not boot a partial image
+    sp->words[0] = FLASHER_IMAGE_MAGIC;
+    sp->words[1] = sp->end - 8;
+    return NVM_Write(gNvmInternalInterface_c, type, sp->words, 0, 8);
+}
+
 /**
  * Set the basic configuration for the whole platform.  This can vary with the
  * application.
@@ -53,8 +301,10 @@ void Main(void)
 {
     nvmType_t type=0;
     nvmErr_t err;
-    uint32_t len, addr;
-    char c;
+    uint32_t len, addr, size, next, i, elapsed;
+    uint32_t crc;
+    bool sparse = false;
+    int cur = 0;
 
     // initialize the whole platform
     InitPlatform();
@@ -62,6 +312,20 @@ void Main(void)
     // initialize the UART1
     Uart1Init();
 
+    // the millisecond timer measures the programming time, the TMR channels are all
+    // free at boot
+    if (!TimerInit(NULL))
+    {
+        Uart1PutS("Timer init failed\n");
+        while (1);
+    }
+
+    // the UART1 reception is done under interrupt, routed to the FIQ
+    IntAssignHandler(gUart1Int_c, Uart1Int);
+    ITC_SetPriority(gUart1Int_c, gItcFastPriority_c);
+    ITC_EnableInterrupt(gUart1Int_c);
+    IntEnableFIQ();
+
     // start the NVM regulators
     FlashStartReg();
 
@@ -73,8 +337,8 @@ void Main(void)
     Uart1PutU8(type);
     Uart1PutS("\n");
 
-    // erase the flash portion that is not reserved
-    err = NVM_Erase(gNvmInternalInterface_c, type, 0x7FFFFFFF);
+    // erase the flash portion that is not reserved, keep the persistent store
+    err = NVM_Erase(gNvmInternalInterface_c, type, 0x7FFFFFFF & ~KV_SECTOR_MASK);
     Uart1PutS("NVM erase returned: 0x");
     Uart1PutU8(err);
     Uart1PutS("\n");
@@ -91,26 +355,94 @@ void Main(void)
     len += Uart1GetC() << 16;
     len += Uart1GetC() << 24;
 
-    // receive all the chars from the UART
+    // the image must not overlap the persistent store, which was not erased: the first
+    // page is acknowledged with an error before anything is written
+    if (len > FLASHER_IMAGE_END)
+    {
+        Uart1PutC(gNvmErrAddressSpaceOverflow_c);
+        for (i = 0; i < 4; i++)
+        {
+            Uart1PutC(0);
+        }
+        Uart1PutS("Image too long, len = 0x");
+        Uart1PutU32(len);
+        Uart1PutS(", max = 0x");
+        Uart1PutU32(FLASHER_IMAGE_END);
+        Uart1PutS("\n");
+        while (1);
+    }
+
+    // the host sends up to 2 pages ahead of the acknowledgments: the next page is
+    // received under interrupt while the current one is written
+    TimerStart(0xFFFF);
+    size = (len > FLASHER_PAGE_SIZE) ? FLASHER_PAGE_SIZE : len;
+    Uart1ReadStart(flasher_page[cur], size);
     addr = 0;
     while (addr < len)
     {
-        // receive a char from the UART
-        c = Uart1GetC();
-        // write the char to the FLASH
-        err = NVM_Write(gNvmInternalInterface_c, type, &c, addr, 1);
+        // wait for the current page to be received
+        while (Uart1ReadCount() != size) ;
+
+        // start the reception of the next page
+        next = len - addr - size;
+        next = (next > FLASHER_PAGE_SIZE) ? FLASHER_PAGE_SIZE : next;
+        Uart1ReadStart(flasher_page[cur ^ 1], next);
+
+        // write the current page to the FLASH, or place the segments of a segment table
+        // image, recognized from its first word
+        if (!addr && (flasher_page[cur][0] == FLASHER_SPARSE_MAGIC))
+        {
+            sparse = true;
+            FlasherSparseStart();
+        }
+        if (sparse)
+        {
+            err = FlasherSparse(type, (uint8_t const *)flasher_page[cur], size);
+        }
+        else
+        {
+            err = NVM_Write(gNvmInternalInterface_c, type, flasher_page[cur], addr, size);
+        }
+
+        // acknowledge the page with the status and the CRC32 of the page received
+        // (little endian), which allows the host to send the page after the next one
+        crc = Crc32(CRC32_INIT, flasher_page[cur], size) ^ 0xFFFFFFFF;
+        Uart1PutC(err);
+        for (i = 0; i < 4; i++)
+        {
+            Uart1PutC(crc >> (i * 8));
+        }
         if (err)
         {
             break;
         }
-        // send back the written char for acknowledgment
-        Uart1PutC(c);
-        // increment the address of the next char
-        addr++;
+
+        addr += size;
+        size = next;
+        cur ^= 1;
+    }
+    if (sparse && !err)
+    {
+        err = FlasherSparseEnd(type);
+        Uart1PutS("Segments placed, image len = 0x");
+        Uart1PutU32(flasher_sparse.end - 8);
+        Uart1PutS(", returned: 0x");
+        Uart1PutU8(err);
+        Uart1PutS("\n");
     }
+    elapsed = TimerGet();
+    TimerStop();
 
     Uart1PutS("Programming done, len = 0x");
     Uart1PutU32(len);
+    Uart1PutS(", time (ms) = 0x");
+    Uart1PutU32(elapsed);
+    if (elapsed)
+    {
+        Uart1PutS(", throughput (KB/s) = 0x");
+        Uart1PutU32(Divide(addr * 1000, elapsed) >> 10);
+    }
+    Uart1PutS("\n");
 
     // wait forever
     while (1);
@@ -21,84 +21,116 @@
 #include "proc/proc.h"
 
 #include "common/Uart1.h"
+#include "common/Tmr.h"
+#include "common/Wave.h"
+#include "common/Keypad.h"
+#include "common/Itc.h"
+#include "common/RoscCal.h"
 
 #include "reg_gpio.h"
 #include "reg_crm.h"
-#include "reg_itc.h"
-#include "reg_tmr0.h"
-#include "reg_tmr1.h"
-
-// defines necessary for the ITC block
-#define ITC_CRM_INDEX (3)
 
 // use GPIO8 (TMR0) as the VSYNC output
 #define VSYNC_OUT_GPIO (8)
+#define VSYNC_OUT_TMR  (0)
+
+// VSYNC periods (24 Mhz/ (128 * 3125) = 60, 24 Mhz/ (128 * 3750) = 50,
+// 24 Mhz/ (128 * 3906) = 48)
+#define VSYNC_60HZ (3125)
+#define VSYNC_50HZ (3750)
+#define VSYNC_48HZ (3906)
+
+// VSYNC patterns: 1 pulse or 3 pulses of 2 ticks, separated by 2 ticks
+//
+// A tick of the peripheral clock divided by 128 is 5.33us, the longest prescaler, and
+// the pulses are 10.7us.  The waveform engine reloads the compares two edges ahead, so
+// the worst case latency budget of the TMR interrupt is the two shortest consecutive
+// segments: 4 ticks = 21.3us (512 CPU cycles at 24MHz).  The TMR is the only FIQ and
+// the FIQ is not masked by the IRQ handlers, so only its own handler and the critical
+// sections count against that budget.
+#define VSYNC_1_PULSE(period)                                               \
+    { {1, 2}, {0, (period) - 2} }
+#define VSYNC_3_PULSES(period)                                              \
+    { {1, 2}, {0, 2}, {1, 2}, {0, 2}, {1, 2}, {0, (period) - 10} }
+
+static struct wave_segment const vsync_1_pulse[3][2] =
+{
+    VSYNC_1_PULSE(VSYNC_60HZ),
+    VSYNC_1_PULSE(VSYNC_50HZ),
+    VSYNC_1_PULSE(VSYNC_48HZ),
+};
+static struct wave_segment const vsync_3_pulses[3][6] =
+{
+    VSYNC_3_PULSES(VSYNC_60HZ),
+    VSYNC_3_PULSES(VSYNC_50HZ),
+    VSYNC_3_PULSES(VSYNC_48HZ),
+};
 
-// VSYNC period (24 Mhz/ (128 * 3125) = 60)
-volatile uint32_t vsync_period = 3125;
-// number of edges
-volatile uint32_t vsync_pulses = 0;
+// VSYNC rate (index in the patterns) and number of pulses
+static uint8_t vsync_rate = 0;
+static uint8_t vsync_pulses = 0;
 
+/**
+ * Change the VSYNC pattern generated according to the rate and number of pulses.
+ */
+static void
+VsyncUpdate(void)
+{
+    if (vsync_pulses)
+    {
+        WaveSet(vsync_3_pulses[vsync_rate], 6);
+    }
+    else
+    {
+        WaveSet(vsync_1_pulse[vsync_rate], 2);
+    }
+}
 
-__FIQ void FiqHandler(void)
+/**
+ * Change the VSYNC upon push button press: PB0 to PB2 select the rate, PB3 the number
+ * of pulses.
+ * @param[in] key Push button pressed
+ */
+static void
+VsyncKey(uint8_t key)
 {
-    uint8_t fiq;
+    switch (key)
+    {
+    case 0:
+        Uart1PutS("60Hz\n");
+        gpio_data_set0_set(1 << 23);
+        gpio_data_reset0_set(6 << 23);
+        vsync_rate = 0;
+        break;
 
-    // check were the FIQ is coming from
-    fiq = itc_fivector_getf();
+    case 1:
+        Uart1PutS("50Hz\n");
+        gpio_data_set0_set(2 << 23);
+        gpio_data_reset0_set(5 << 23);
+        vsync_rate = 1;
+        break;
 
-    switch (fiq)
-    {
-    case ITC_CRM_INDEX:
-        fiq = crm_ext_wu_evt_getf();
-        Uart1PutS("CRM FIQ\n");
+    case 2:
+        Uart1PutS("48Hz\n");
+        gpio_data_set0_set(4 << 23);
+        gpio_data_reset0_set(3 << 23);
+        vsync_rate = 2;
+        break;
 
-        if (fiq & 1)
+    case 3:
+        if (vsync_pulses)
         {
-            Uart1PutS("60Hz\n");
-            gpio_data_set0_set(1 << 23);
-            gpio_data_reset0_set(6 << 23);
-            // VSYNC period (24 Mhz/ (128 * 3125) = 60)
-            vsync_period = 3125;
+            vsync_pulses = 0;
+            Uart1PutS("1 pulse\n");
         }
-        if (fiq & 2)
+        else
         {
-            Uart1PutS("50Hz\n");
-            gpio_data_set0_set(2 << 23);
-            gpio_data_reset0_set(5 << 23);
-            // VSYNC period (24 Mhz/ (128 * 3750) = 50)
-            vsync_period = 3750;
+            vsync_pulses = 1;
+            Uart1PutS("3 pulses\n");
         }
-        if (fiq & 4)
-        {
-            Uart1PutS("48Hz\n");
-            gpio_data_set0_set(4 << 23);
-            gpio_data_reset0_set(3 << 23);
-            // VSYNC period (24 Mhz/ (128 * 3906) = 48)
-            vsync_period = 3906;
-        }
-        if (fiq & 8)
-        {
-            if (vsync_pulses)
-            {
-                vsync_pulses = 0;
-                Uart1PutS("1 pulse\n");
-            }
-            else
-            {
-                vsync_pulses = 1;
-                Uart1PutS("3 pulses\n");
-            }
-        }
-
-        // clear any pending interrupt
-        crm_status_set(0xFFFF);
-        break;
-        
-    default:
-        Uart1PutS("Unsupported FIQ\n");
         break;
     }
+    VsyncUpdate();
 }
 
 /**
@@ -138,7 +170,8 @@ InitPlatform(void)
 
     // + function configuration
     //   * configure the GPIO15-14 to UART1 (UART1 TX and RX)
-    gpio_func_sel0_set((0x01 << (14*2)) | (0x01 << (15*2)));
+    //   * configure the VSYNC out GPIO to the TMR output
+    gpio_func_sel0_set((0x01 << (14*2)) | (0x01 << (15*2)) | (0x01 << (VSYNC_OUT_GPIO*2)));
 
     // + pull up configuration
     //   * enable the PU on the GPIO 29-26 (KBI[7..4]), connected to PushButtons
@@ -150,24 +183,20 @@ InitPlatform(void)
     gpio_data0_set(1<<23);
 
     // ITC configuration:
-    // enable CRM and TMR in interrupt controller
-    itc_intenable_setf((1<<ITC_CRM_INDEX));
-    itc_inttype_setf((1<<ITC_CRM_INDEX));
-
-    // clear pending interrupts from the CRM after the GPIO PD/PU configuration is stable
-    {
-        volatile uint32_t toto =0;
-        while (toto++ < 10000) ;
-    }
-    crm_status_set(0xFFFF);
+    // + CRM to IRQ for the push buttons
+    // + TMR to FIQ for the VSYNC, never delayed by the push buttons
+    ItcInit();
+    ItcSet(ITC_SRC_CRM, KeypadInt, ITC_IRQ);
+    ItcSet(ITC_SRC_TMR, TmrInt, ITC_FIQ);
+
+    // the pads settle while the platform initializes, KeypadInit clears the events
+    // their PD/PU configuration caused and the debouncing ignores the later glitches
 }
 
 
 void Main(void)
 {
-    int state;
-    uint16_t limit;
-    uint32_t value;
+    struct keypad_event key;
 
     // initialize the whole platform
     InitPlatform();
@@ -175,88 +204,23 @@ void Main(void)
     // initialize the UART1
     Uart1Init();
 
+    // measure the ring oscillator with its trims for the debounce times, and wait for
+    // the push buttons
+    RoscCalApply(11, 24);
+    KeypadInit(NULL);
+
+    // generate the VSYNC on the TMR0 output, counting the peripheral clock divided by 128
+    WaveStart(VSYNC_OUT_TMR, TMR_SRC_CLK_DIV(7), vsync_1_pulse[0], 2);
+
     // release the interrupts
     PROC_INT_START();
 
-    // configure timer 0:
-    //    - count rising edges
-    //    - primary source = peripheral clock divide by 128 (0xf)
-    //    - count repeatedly
-    //    - count up
-    //    - no co_init and no OFLAG
-    tmr0_ctrl_pack(1, 0xf, 0, 0, 0, 0, 0, 0);
-    tmr0_sctrl_set(0);
-    tmr0_csctrl_set(0);
-
+    // the edges are generated by the TMR, only the push buttons are left
     while (1)
     {
-        // reinit the TMR0 counter
-        tmr0_cntr_set(0);
-        state = 0;
-
-        do
+        if (KeypadGet(&key) && (key.type == KEYPAD_PRESS))
         {
-            switch (state)
-            {
-            case 0:
-                limit = 2;
-                value = 1;
-                state = 1;
-                break;
-            case 1:
-                limit = 4;
-                value = 0;
-                if (vsync_pulses)
-                {
-                    // 3 pulses option
-                    state = 2;
-                }
-                else
-                {
-                    // 1 pulse option
-                    state = 6;
-                }
-                break;
-            case 2:
-                limit = 6;
-                value = 1;
-                state = 3;
-                break;
-            case 3:
-                limit = 8;
-                value = 0;
-                state = 4;
-                break;
-            case 4:
-                limit = 10;
-                value = 1;
-                state = 5;
-                break;
-            case 5:
-                limit = 12;
-                value = 0;
-                state = 6;
-                break;
-            case 6:
-                limit = vsync_period;
-                value = 0;
-                state = 0;
-                break;
-            }
-
-            // toggle high or low?
-            if (value)
-            {
-                gpio_data_set0_set(1 << VSYNC_OUT_GPIO);
-            }
-            else
-            {
-                gpio_data_reset0_set(1 << VSYNC_OUT_GPIO);
-            }
-            // wait for the limit to be reached
-            while (tmr0_cntr_get() < limit) ;
-    
-        } while (state != 0);
+            VsyncKey(key.key);
+        }
     }
 }
-
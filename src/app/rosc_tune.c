@@ -21,29 +21,16 @@
 #include "proc/proc.h"
 
 #include "common/Uart1.h"
+#include "common/RoscCal.h"
+#include "common/Time.h"
+#include "common/Flash.h"
+#include "common/KvStore.h"
+
+#include "NVM.h"
 
 #include "reg_gpio.h"
 #include "reg_crm.h"
-#include "reg_itc.h"
-#include "reg_tmr0.h"
-#include "reg_tmr1.h"
-
-
-__FIQ void FiqHandler(void)
-{
-    uint8_t fiq;
-
-    // check were the FIQ is coming from
-    fiq = itc_fivector_getf();
 
-    switch (fiq)
-    {
-    default:
-        Uart1PutS("\nUnsupported FIQ");
-        ASSERT(0);
-        break;
-    }
-}
 
 /**
  * Set the basic configuration for the whole platform.  This can vary with the
@@ -67,7 +54,7 @@ InitPlatform(void)
             EXT_WU_IEN_MASK | EXT_WU_EN_MASK | EXT_WU_EDGE_MASK);
 
     // + ring oscillator configuration
-    //   + tune the 2kHz oscillator (coarse=11, fine=24, dependent on every chip)
+    //   + start the 2kHz oscillator with typical trims, calibrated afterwards
     crm_ringosc_cntl_pack(11, 24, 1);
 
     // + status configuration
@@ -92,58 +79,95 @@ InitPlatform(void)
     //   * clear the LEDs
     gpio_data0_set(0);
 
-    // ITC configuration:
-    // + disable all interrupts in interrupt controller
-    itc_intenable_setf(0);
-    // + set all interrupts to IRQ
-    itc_inttype_setf(0);
-
     // clear pending interrupts from the CRM after the GPIO PD/PU configuration is stable
-    {
-        volatile uint32_t toto =0;
-        while (toto++ < 10000) ;
-    }
+    TimeWaitUntil(TimeGet() + TimeMsToTicksUp(TIME_PADS_SETTLE_MS));
     crm_status_set(0xFFFF);
 
 }
 
 
+/**
+ * Print a calibration result.
+ * @param[in] cal Calibration result
+ */
+static void
+PrintCal(struct rosc_cal const *cal)
+{
+    Uart1PutS("\nCTUNE = ");
+    Uart1PutU8(cal->ctune);
+    Uart1PutS(", FTUNE = ");
+    Uart1PutU8(cal->ftune);
+    Uart1PutS(", 16xRTC = ");
+    Uart1PutU32(cal->cycles);
+}
+
+/**
+ * Open the persistent store.
+ * @return KV_OK if the store is usable
+ */
+static kvErr_t
+InitStore(void)
+{
+    nvmType_t type = 0;
+
+    // start the NVM regulators
+    FlashStartReg();
+
+    // detect the NVM type
+    if (NVM_Detect(gNvmInternalInterface_c, &type) != gNvmErrNoError_c)
+    {
+        return KV_ERR_NVM;
+    }
+
+    return KvInit(type);
+}
+
 void Main(void)
 {
+    struct rosc_cal const *cal;
+    uint8_t trim[2];
+    uint8_t len = sizeof(trim);
+    kvErr_t kv;
+    uint32_t rtc;
+
     // initialize the whole platform
     InitPlatform();
 
     // initialize the UART1
     Uart1Init();
 
-    // configure timer 0:
-    //    - count rising edges
-    //    - primary source = peripheral clock
-    //    - count repeatedly
-    //    - count up
-    //    - no co_init and no OFLAG
-    tmr0_ctrl_pack(1, 8, 0, 0, 0, 0, 0, 0);
-    tmr0_sctrl_set(0);
-    tmr0_csctrl_set(0);
-
-    while (1)
+    // start from the trims of the previous calibration if any
+    kv = InitStore();
+    if ((kv == KV_OK) &&
+        (KvGet(KV_KEY_ROSC_TRIM, trim, &len) == KV_OK) && (len == sizeof(trim)))
     {
-        volatile uint32_t rtc, counter;
+        Uart1PutS("\nStored trims");
+        PrintCal(RoscCalApply(trim[0], trim[1]));
+    }
 
-        // wait until RTC counter switches
-        while (crm_rtc_count_get() == crm_rtc_count_get()) ;
+    // search the trims from scratch
+    Uart1PutS("\nRing oscillator calibration, target 16xRTC = ");
+    Uart1PutU32(ROSC_CAL_TARGET);
+    cal = RoscCalRun();
+    PrintCal(cal);
 
-        // reinit the TMR0 counter
-        tmr0_cntr_set(0);
+    // store the result for the next boot, the tracking below is not stored to save
+    // the flash endurance
+    if (kv == KV_OK)
+    {
+        trim[0] = cal->ctune;
+        trim[1] = cal->ftune;
+        kv = KvSet(KV_KEY_ROSC_TRIM, trim, sizeof(trim));
+    }
+    Uart1PutS("\nStore status = ");
+    Uart1PutU8(kv);
 
-        // save the current counter
+    // follow the drift every second
+    while (1)
+    {
         rtc = crm_rtc_count_get();
+        while (TimeDiff(crm_rtc_count_get(), rtc) < (int32_t)TimeMsToTicks(1000)) ;
 
-        while (crm_rtc_count_get() != (rtc+4)) ;
-        counter = tmr0_cntr_get();
-
-        Uart1PutS("\n4xRTC = ");
-        Uart1PutU16(counter);
+        PrintCal(RoscCalTrack());
     }
 }
-
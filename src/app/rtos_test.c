@@ -22,16 +22,33 @@
 #include "proc/proc.h"
 
 #include "common/Uart1.h"
+#include "common/Tmr.h"
 #include "common/Timer.h"
+#include "common/Clock.h"
+#include "common/RoscCal.h"
+#include "common/Adc.h"
+#include "common/Keypad.h"
+#include "common/Itc.h"
+#include "common/IsrProf.h"
+#include "common/Time.h"
+
+#include "boot/Boot.h"
 
 #include "reg_gpio.h"
 #include "reg_crm.h"
-#include "reg_itc.h"
 
 
-// defines necessary for the ITC block
-#define ITC_CRM_INDEX (3)
-#define ITC_TMR_INDEX (5)
+// ADC acquisition: channel 5 sampled at 1kHz, statistics printed every 16 buffers
+#define ADC_CHANNEL (5)
+#define ADC_PERIOD_US (1000)
+#define ADC_PRINT_MASK (0xF)
+
+// ADC alert: window on the same channel, reported at most every 500ms
+#define ADC_ALERT (0)
+#define ADC_ALERT_LOW (0x400)
+#define ADC_ALERT_HIGH (0xC00)
+#define ADC_ALERT_HYST (0x40)
+#define ADC_ALERT_HOLDOFF_MS (500)
 
 // import symbols from the linker scripts
 extern char stack_base_svc;
@@ -48,106 +65,244 @@ enum
     PB1_RSP,
     PB1_REQ,
     PB1_CFM,
+    ADC_IND = 0x200,
 };
 
-__FIQ void FiqHandler(void)
+/**
+ * Callback upon timer expiry, prints the elapsed time and restarts the timer.
+ */
+static void
+TimerExpired(void)
 {
-    uint8_t fiq;
+    Uart1PutS("\nTIMER expired");
 
-    // check were the FIQ is coming from
-    fiq = itc_fivector_getf();
+    Uart1PutS("\nRTC_COUNT = ");
+    {
+        static uint32_t last = 0;
+        uint32_t current = 0;
+        current = crm_rtc_count_get();
+        Uart1PutU32(current - last);
+        last = current;
+    }
 
-    switch (fiq)
+    Uart1PutS("\nCLOCK (us) = ");
     {
-    case ITC_CRM_INDEX:
-        fiq = crm_ext_wu_evt_getf();
+        static uint32_t last = 0;
+        uint32_t current = 0;
+        current = ClockGet32();
+        Uart1PutU32(ClockTicksToUs(current - last));
+        last = current;
+    }
 
-        Uart1PutS("\nCRM FIQ");
+    TimerStart(1000);
+}
 
-        if (fiq & 1)
-        {
-            rtos_eventraise(RTOS_EVENT(PB0));
-            Uart1PutS("\nPB0");
-        }
-        if (fiq & 2)
+/**
+ * Callback when a push button event is queued, the events are read by the RTOS.
+ */
+static void
+KeyReady(void)
+{
+    rtos_eventraise(RTOS_EVENT(KEY));
+}
+
+void event_key(void)
+{
+    static char const * const types[] =
+    {
+        [KEYPAD_PRESS]        = " pressed",
+        [KEYPAD_RELEASE]      = " released",
+        [KEYPAD_LONG_PRESS]   = " long press",
+        [KEYPAD_REPEAT_PRESS] = " repeat"
+    };
+    struct keypad_event key;
+
+    rtos_eventclear(RTOS_EVENT(KEY));
+
+    while (KeypadGet(&key))
+    {
+        Uart1PutS("\nEVT_PB");
+        Uart1PutU8(key.key);
+        Uart1PutS(types[key.type]);
+
+        if (key.type != KEYPAD_PRESS)
         {
-            rtos_eventraise(RTOS_EVENT(PB1));
-            Uart1PutS("\nPB1");
+            continue;
         }
-        if (fiq & 4)
+
+        // send an indication to the thread0 for PB0, to the thread1 for PB1
+        if (key.key == 0)
         {
-            rtos_eventraise(RTOS_EVENT(PB2));
-            Uart1PutS("\nPB2");
+            rtos_msg_post(RTOS_T_THREAD0, PB0_IND, 0);
         }
-        if (fiq & 8)
+        else if (key.key == 1)
         {
-            rtos_eventraise(RTOS_EVENT(PB3));
-            Uart1PutS("\nPB3");
+            rtos_msg_post(RTOS_T_THREAD1, PB1_IND, 0);
         }
-        // clear any pending interrupt
-        crm_status_set(0xFFFF);
-        break;
-
-    case ITC_TMR_INDEX:
-        TimerInt();
+    }
+}
 
-        Uart1PutS("\nRTC_COUNT = ");
-        {
-            static uint32_t last = 0;
-            uint32_t current = 0;
-            current = crm_rtc_count_get();
-            Uart1PutU32(current - last);
-            last = current;
-        }
+/**
+ * Callback when an ADC buffer is full, the buffer is handed to the RTOS.
+ */
+static void
+AdcReady(void)
+{
+    rtos_eventraise(RTOS_EVENT(ADC));
+}
 
-        TimerStart(1000);
+void event_adc(void)
+{
+    uint16_t const **ind;
+    uint16_t const *samples;
 
-        break;
+    rtos_eventclear(RTOS_EVENT(ADC));
 
-    default:
-        Uart1PutS("\nUnsupported FIQ");
-        ASSERT(0);
-        break;
+    // send the full buffers to the thread0
+    while ((samples = AdcBufferGet()) != NULL)
+    {
+        ind = rtos_msg_post(RTOS_T_THREAD0, ADC_IND, sizeof(*ind));
+        *ind = samples;
     }
 }
 
-void event_pb0(void)
-{
-    Uart1PutS("\nEVT_PB0");
-
-    // send an indication to the thread0
-    rtos_msg_post(RTOS_T_THREAD0, PB0_IND, 0);
+/// Last zone reported by the ADC alert
+static volatile uint8_t adc_alert_zone;
 
-    rtos_eventclear(RTOS_EVENT(PB0));
+/**
+ * Callback upon ADC window crossing, the zone is printed by the RTOS.
+ * @param[in] alert Alert
+ * @param[in] zone New position of the channel
+ */
+static void
+AdcAlert(uint8_t alert, enum adc_zone zone)
+{
+    adc_alert_zone = zone;
+    rtos_eventraise(RTOS_EVENT(ADC_ALERT));
 }
 
-void event_pb1(void)
+void event_adc_alert(void)
 {
-    Uart1PutS("\nEVT_PB1");
+    static char const * const zones[] =
+    {
+        [ADC_ZONE_INSIDE] = "inside",
+        [ADC_ZONE_ABOVE]  = "above",
+        [ADC_ZONE_BELOW]  = "below"
+    };
+
+    rtos_eventclear(RTOS_EVENT(ADC_ALERT));
+
+    Uart1PutS("\nADC alert: ");
+    Uart1PutS(zones[adc_alert_zone]);
+}
 
-    // send an indication to the thread1
-    rtos_msg_post(RTOS_T_THREAD1, PB1_IND, 0);
+/// Command received on the UART
+static char cmd;
 
-    rtos_eventclear(RTOS_EVENT(PB1));
+/**
+ * UART1 interrupt: a command char was received, it is processed by the RTOS.
+ */
+static void
+CmdInt(void)
+{
+    Uart1Int();
+    if (Uart1ReadCount())
+    {
+        rtos_eventraise(RTOS_EVENT(CMD));
+    }
 }
 
-void event_pb2(void)
+void event_cmd(void)
 {
-    Uart1PutS("\nEVT_PB2");
+    rtos_eventclear(RTOS_EVENT(CMD));
 
-    rtos_eventclear(RTOS_EVENT(PB2));
+    switch (cmd)
+    {
+        case 'p':
+            // print the interrupt handlers profile
+            IsrProfDump();
+#ifdef PROC_INT_DEBUG
+            {
+                struct proc_int_stats stats;
+
+                proc_int_stats_get(&stats);
+                Uart1PutS("\nInterrupts disabled: max (us) = 0x");
+                Uart1PutU32(ClockTicksToUs(stats.max));
+                Uart1PutS(" at ");
+                Uart1PutS(stats.file);
+                Uart1PutS(":0x");
+                Uart1PutU16(stats.line);
+                Uart1PutS(", overruns = 0x");
+                Uart1PutU32(stats.overruns);
+            }
+#endif
+            break;
+
+        case 'r':
+            // reset the interrupt handlers profile
+            IsrProfReset();
+#ifdef PROC_INT_DEBUG
+            proc_int_stats_reset();
+#endif
+            Uart1PutS("\nISR profile reset");
+            break;
+
+        default:
+            break;
+    }
+
+    // wait for the next command
+    Uart1ReadStart(&cmd, 1);
 }
 
-void event_pb3(void)
+/**
+ * Process a buffer of ADC samples: print the statistics from time to time.
+ * @param[in] samples ADC_BUFFER_SIZE samples
+ */
+static void
+AdcProcess(uint16_t const *samples)
 {
-    Uart1PutS("\nEVT_PB3");
+    static uint32_t buffers = 0;
+    uint32_t sum = 0;
+    uint16_t min = 0xFFF, max = 0, value;
+    int i;
+
+    for (i = 0; i < ADC_BUFFER_SIZE; i++)
+    {
+        value = ADC_SAMPLE_VALUE(samples[i]);
+        sum += value;
+        if (value < min)
+        {
+            min = value;
+        }
+        if (value > max)
+        {
+            max = value;
+        }
+    }
 
-    rtos_eventclear(RTOS_EVENT(PB3));
+    if (!(buffers++ & ADC_PRINT_MASK))
+    {
+        Uart1PutS("\nADC: min = 0x");
+        Uart1PutU16(min);
+        Uart1PutS(", max = 0x");
+        Uart1PutU16(max);
+        Uart1PutS(", mean = 0x");
+        Uart1PutU16(sum / ADC_BUFFER_SIZE);
+        Uart1PutS(", overruns = 0x");
+        Uart1PutU32(AdcOverruns());
+    }
 }
 
 void Thread0(void)
 {
     Uart1PutS("\nThread0 started");
+
+    // boot time, the RTC rate is calibrated
+    Uart1PutS("\nBoot (ms): reset to Main = 0x");
+    Uart1PutU32(TimeTicksToMs(boot_time.main - boot_time.reset));
+    Uart1PutS(", to first dispatch = 0x");
+    Uart1PutU32(TimeTicksToMs(boot_time.dispatch - boot_time.reset));
     while (1)
     {
         void *msg;
@@ -192,6 +347,16 @@ void Thread0(void)
 
             break;
         }
+        case ADC_IND:
+        {
+            uint16_t const *samples = *(uint16_t const **) msg;
+
+            rtos_msg_free(msg);
+            AdcProcess(samples);
+            AdcBufferRelease(samples);
+
+            break;
+        }
         default:
             Uart1PutS("\nThread0: unknown message received");
             break;
@@ -280,7 +445,7 @@ InitPlatform(void)
             EXT_WU_IEN_MASK | EXT_WU_EN_MASK | EXT_WU_EDGE_MASK);
 
     // + ring oscillator configuration
-    //   + tune the 2kHz oscillator (coarse=11, fine=24, dependent on every chip)
+    //   + start the 2kHz oscillator with typical trims, calibrated afterwards
     crm_ringosc_cntl_pack(11, 24, 1);
 
     // + status configuration
@@ -306,34 +471,65 @@ InitPlatform(void)
     gpio_data0_set(0);
 
     // ITC configuration:
-    // enable CRM and TMR in interrupt controller
-    itc_intenable_setf((1<<ITC_CRM_INDEX) | (1<<ITC_TMR_INDEX));
-    itc_inttype_setf((1<<ITC_CRM_INDEX) | (1<<ITC_TMR_INDEX));
-
-    // clear pending interrupts from the CRM after the GPIO PD/PU configuration is stable
-    {
-        volatile uint32_t toto =0;
-        while (toto++ < 10000) ;
-    }
-    crm_status_set(0xFFFF);
-
+    // + CRM to IRQ for the push buttons
+    // + TMR to FIQ for the clock and the timer
+    // + ADC to IRQ for the acquisition, preempting the push buttons
+    // + UART1 to IRQ for the commands, lowest priority
+    ItcInit();
+    ItcSet(ITC_SRC_UART1, CmdInt, ITC_IRQ);
+    ItcSet(ITC_SRC_CRM, KeypadInt, ITC_IRQ);
+    ItcSet(ITC_SRC_TMR, TmrInt, ITC_FIQ);
+    ItcSet(ITC_SRC_ADC, AdcInt, ITC_IRQ);
+
+    // the pads settle while the platform initializes, KeypadInit clears the events
+    // their PD/PU configuration caused and the debouncing ignores the later glitches
 }
 
 
 void Main(void)
 {
+    // note the date for the boot time measurement
+    boot_time.main = TimeGet();
+
     // initialize the whole platform
     InitPlatform();
 
     // initialize the UART1
     Uart1Init();
 
-    // initialize the TMR
-    TimerInit();
+    // calibrate the ring oscillator, this also gives the RTC rate to the RTOS timeouts
+    {
+        struct rosc_cal const *cal = RoscCalRun();
+
+        Uart1PutS("\nROSC calibrated: CTUNE = ");
+        Uart1PutU8(cal->ctune);
+        Uart1PutS(", FTUNE = ");
+        Uart1PutU8(cal->ftune);
+    }
+
+    // initialize the TMR, then the monotonic clock on TMR2 and TMR3
+    if (!TimerInit(TimerExpired) || !ClockInit())
+    {
+        Uart1PutS("\nTMR allocation failed");
+        while (1) ;
+    }
+
+    // profile the interrupt handlers, dumped with the 'p' command and reset with 'r'
+    IsrProfStart();
+    Uart1ReadStart(&cmd, 1);
 
     // configure a timer in 1s
     TimerStart(1000);
 
+    // debounce the push buttons, the RTC rate is calibrated
+    KeypadInit(KeyReady);
+
+    // start the ADC acquisition
+    AdcInit();
+    AdcStart(1 << ADC_CHANNEL, ADC_PERIOD_US, AdcReady);
+    AdcAlertSet(ADC_ALERT, ADC_CHANNEL, ADC_ALERT_LOW, ADC_ALERT_HIGH, ADC_ALERT_HYST,
+            ADC_ALERT_HOLDOFF_MS, AdcAlert);
+
     // Debug information
     Uart1PutS("\nRTOS started: 0x");
     Uart1PutU32(0xCAFEBABE);
@@ -21,28 +21,35 @@
 #include "proc/proc.h"
 
 #include "common/Uart1.h"
+#include "common/XtalDisc.h"
+#include "common/Time.h"
+#include "common/Flash.h"
+#include "common/KvStore.h"
+
+#include "NVM.h"
+#include "Interrupt.h"
 
 #include "reg_gpio.h"
 #include "reg_crm.h"
-#include "reg_itc.h"
-#include "reg_tmr0.h"
-#include "reg_tmr1.h"
-
 
-__FIQ void FiqHandler(void)
-{
-    uint8_t fiq;
 
-    // check were the FIQ is coming from
-    fiq = itc_fivector_getf();
+/// Number of measurements before the filtered error is stored (several time
+/// constants of the discipline filter)
+#define XTAL32_TUNE_STORE_SAMPLES (4 << XTAL_DISC_FILTER_LOG2)
 
-    switch (fiq)
+/**
+ * Handler of the CRM interrupt, the end of the calibration is signaled to the
+ * discipline.
+ */
+static void
+CrmInt(void)
+{
+    if (crm_cal_done_getf())
     {
-    default:
-        Uart1PutS("\nUnsupported FIQ");
-        ASSERT(0);
-        break;
+        XtalDiscInt();
     }
+    // clear any other pending interrupt
+    crm_status_set(0xFFFF);
 }
 
 /**
@@ -97,24 +104,47 @@ InitPlatform(void)
     //   * clear the LEDs
     gpio_data0_set(0);
 
-    // ITC configuration:
-    // + disable all interrupts in interrupt controller
-    itc_intenable_setf(0);
-    // + set all interrupts to IRQ
-    itc_inttype_setf(0);
+    // ITC configuration (ROM dispatch):
+    // + CRM to FIQ for the calibration
+    IntAssignHandler(gCrmInt_c, CrmInt);
+    ITC_SetPriority(gCrmInt_c, gItcFastPriority_c);
+    ITC_EnableInterrupt(gCrmInt_c);
 
     // clear pending interrupts from the CRM after the GPIO PD/PU configuration is stable
-    {
-        volatile uint32_t toto =0;
-        while (toto++ < 10000) ;
-    }
+    TimeWaitUntil(TimeGet() + TimeMsToTicksUp(TIME_PADS_SETTLE_MS));
     crm_status_set(0xFFFF);
 
 }
 
 
+/**
+ * Open the persistent store.
+ * @return KV_OK if the store is usable
+ */
+static kvErr_t
+InitStore(void)
+{
+    nvmType_t type = 0;
+
+    // start the NVM regulators
+    FlashStartReg();
+
+    // detect the NVM type
+    if (NVM_Detect(gNvmInternalInterface_c, &type) != gNvmErrNoError_c)
+    {
+        return KV_ERR_NVM;
+    }
+
+    return KvInit(type);
+}
+
 void Main(void)
 {
+    int32_t ppm;
+    uint8_t len = sizeof(ppm);
+    kvErr_t kv;
+    int stored = 0;
+
     // initialize the whole platform
     InitPlatform();
 
@@ -130,36 +160,45 @@ void Main(void)
     Uart1PutS("\nFIRST = ");
     Uart1PutU32(crm_rtc_count_get());
 
-    // configure timer 0:
-    //    - count rising edges
-    //    - primary source = peripheral clock
-    //    - count repeatedly
-    //    - count up
-    //    - no co_init and no OFLAG
-    tmr0_ctrl_pack(1, 8, 0, 0, 0, 0, 0, 0);
-    tmr0_sctrl_set(0);
-    tmr0_csctrl_set(0);
+    // print the error stored by a previous run if any
+    kv = InitStore();
+    if ((kv == KV_OK) &&
+        (KvGet(KV_KEY_XTAL32_TRIM, &ppm, &len) == KV_OK) && (len == sizeof(ppm)))
+    {
+        Uart1PutS("\nStored ppm (Q8) = ");
+        Uart1PutU32(ppm);
+    }
+
+    // measure the crystal continuously
+    XtalDiscStart();
+
+    // enable the FIQ
+    IntEnableFIQ();
 
     while (1)
     {
-        volatile uint32_t rtc, counter;
-
-        // wait until RTC counter switches
-        while (crm_rtc_count_get() == crm_rtc_count_get())
+        struct xtal_disc const *disc = XtalDiscGet();
+        uint32_t samples = disc->samples;
+
+        // wait for the next measurement
+        while (disc->samples == samples) ;
+
+        Uart1PutS("\n32768xRTC = ");
+        Uart1PutU32(disc->cycles);
+        Uart1PutS(", filtered = ");
+        Uart1PutU32(disc->filtered >> 4);
+        Uart1PutS(", ppm (Q8) = ");
+        Uart1PutU32(disc->ppm);
+
+        // store the error once the filter has converged, only once to save the flash
+        // endurance
+        if ((kv == KV_OK) && !stored && (disc->samples >= XTAL32_TUNE_STORE_SAMPLES))
         {
+            stored = 1;
+            ppm = disc->ppm;
+            kv = KvSet(KV_KEY_XTAL32_TRIM, &ppm, sizeof(ppm));
+            Uart1PutS("\nStore status = ");
+            Uart1PutU8(kv);
         }
-
-        // reinit the TMR0 counter
-        tmr0_cntr_set(0);
-
-        // save the current counter
-        rtc = crm_rtc_count_get();
-
-        while (crm_rtc_count_get() != (rtc+64)) ;
-        counter = tmr0_cntr_get();
-
-        Uart1PutS("\n64xRTC = ");
-        Uart1PutU16(counter);
     }
 }
-
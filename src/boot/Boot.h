@@ -0,0 +1,41 @@
+/*
+ * Boot related API
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BOOT_H_
+#define _BOOT_H_
+
+// standard includes
+#include <stdint.h>
+
+/// RTC dates of the boot steps, see TimeGet()
+struct boot_time
+{
+    /// Reset, noted by Init-RAMonly.s once the stacks and the BSS are set up
+    uint32_t reset;
+
+    /// Entry of Main
+    uint32_t main;
+
+    /// Entry of the RTOS scheduler, right before the first event dispatch
+    uint32_t dispatch;
+};
+
+extern struct boot_time boot_time;
+
+#endif // _BOOT_H_
@@ -170,19 +170,27 @@ boot_reset:
     # Stay in Supervisor Mode
 
     # Init the BSS section
+    # 32 bytes per store, then the remaining 16, 8 and 4 bytes (bits 4, 3 and 2 of
+    # the length moved to C and N)
     LDR     R0, ram_bss_base
     LDR     R1, ram_bss_length
     MOV     R2, #0
     MOV     R3, #0
     MOV     R4, #0
     MOV     R5, #0
+    MOV     R6, #0
+    MOV     R7, #0
+    MOV     R8, #0
+    MOV     R9, #0
 init_bss_loop:
-    SUBS    R1, R1, #16
-    STMCSIA R0!, {R2, R3, R4, R5}
+    SUBS    R1, R1, #32
+    STMCSIA R0!, {R2-R9}
     BHI     init_bss_loop
-    MOVS    R1, R1, LSL #29
-    STMCSIA R0!, {R4, R5}
-    STRMI   R3, [R0]
+    MOVS    R1, R1, LSL #28
+    STMCSIA R0!, {R2-R5}
+    STMMIIA R0!, {R2-R3}
+    MOVS    R1, R1, LSL #2
+    STRCS   R2, [R0]
 
     # ==================
     # Clear Registers
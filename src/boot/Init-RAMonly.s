@@ -1,5 +1,5 @@
 # list of init options
-#.set CLEAR_BSS, 0
+.set CLEAR_BSS, 1
 
 .section .vec, "ax"
     .align  4
@@ -30,8 +30,7 @@ vector_reserved:
     B       vector_reserved
 
     #  - IRQ
-vector_irq:
-    B       vector_irq
+    B       IrqHandler
 
     #  - FIQ
     B       FiqHandler
@@ -60,10 +59,24 @@ vector_irq:
 .set BOOT_FIQ_MASK,     0x40
 .set BOOT_IRQ_MASK,     0x80
 
+.set BOOT_RTC_COUNT_ADDR, 0x80003028
+
 #/* ========================================================================
 # *                                Globals
 # * ======================================================================== */
 
+#/**
+# * RTC dates of the boot steps (see boot/Boot.h), in the data to survive the BSS clear
+# */
+.data
+    .align  2
+    .global boot_time
+boot_time:
+    .word 0, 0, 0
+
+.text
+    .align  4
+
 #/* ========================================================================
 #/**
 # * RAM_BSS
@@ -76,6 +89,18 @@ ram_bss_length:
     .word bss_length
 .endif
 
+#/**
+# * EXEC_RAM_FUNC
+# */
+ram_func_base:
+    .word ramfunc_base
+
+ram_func_load:
+    .word ramfunc_load
+
+ram_func_length:
+    .word ramfunc_length
+
 
 #/* ========================================================================
 # *                                Functions
@@ -99,6 +124,18 @@ boot_reset:
     MOV     R11, #0
     MOV     R12, #0
 
+    # ==================
+    # switch the IRQ mode and keep all interrupts disabled
+    MSR   CPSR_c, #BOOT_FIQ_IRQ_MASK | BOOT_MODE_IRQ
+    LDR   R0, =stack_base_irq
+    MOV   SP, R0
+
+    # ==================
+    # switch the SYS mode, where the nested IRQ handlers run
+    MSR   CPSR_c, #BOOT_FIQ_IRQ_MASK | BOOT_MODE_SYS
+    LDR   R0, =stack_base_sys
+    MOV   SP, R0
+
     # ==================
     # switch the SVC mode and keep all interrupts disabled
     MSR   CPSR_c, #BOOT_FIQ_IRQ_MASK | BOOT_MODE_SVC
@@ -107,21 +144,50 @@ boot_reset:
 
 .ifdef CLEAR_BSS
     # Init the BSS section
+    # 32 bytes per store, then the remaining 16, 8 and 4 bytes (bits 4, 3 and 2 of
+    # the length moved to C and N)
     LDR     R0, ram_bss_base
     LDR     R1, ram_bss_length
     MOV     R2, #0
     MOV     R3, #0
     MOV     R4, #0
     MOV     R5, #0
+    MOV     R6, #0
+    MOV     R7, #0
+    MOV     R8, #0
+    MOV     R9, #0
 init_bss_loop:
-    SUBS    R1, R1, #16
-    STMCSIA R0!, {R2, R3, R4, R5}
+    SUBS    R1, R1, #32
+    STMCSIA R0!, {R2-R9}
     BHI     init_bss_loop
-    MOVS    R1, R1, LSL #29
-    STMCSIA R0!, {R4, R5}
-    STRMI   R3, [R0]
+    MOVS    R1, R1, LSL #28
+    STMCSIA R0!, {R2-R5}
+    STMMIIA R0!, {R2-R3}
+    MOVS    R1, R1, LSL #2
+    STRCS   R2, [R0]
 .endif
 
+    # ==================
+    # Note the reset date, the stacks and BSS setup are far below the RTC resolution
+    LDR     R0, =BOOT_RTC_COUNT_ADDR
+    LDR     R0, [R0]
+    LDR     R1, =boot_time
+    STR     R0, [R1]
+
+    # ==================
+    # Copy the hot code to SRAM, when it is not loaded there already
+    LDR     R0, ram_func_base
+    LDR     R1, ram_func_load
+    LDR     R2, ram_func_length
+    CMP     R0, R1
+    BEQ     init_ramfunc_done
+init_ramfunc_loop:
+    SUBS    R2, R2, #4
+    LDRCS   R3, [R1], #4
+    STRCS   R3, [R0], #4
+    BHI     init_ramfunc_loop
+init_ramfunc_done:
+
     # ==================
     # Clear Registers
     MOV R0, #0
@@ -138,8 +204,9 @@ init_bss_loop:
     MOV R11, #0
     MOV R12, #0
 
-    # call to the main function
-    B Main
+    # call to the main function, built in ARM or Thumb mode
+    LDR     R12, =Main
+    BX      R12
 
 
 
@@ -0,0 +1,401 @@
+/*
+ * ADC acquisition implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "Adc.h"
+
+// for the ADC registers
+#include "reg_adc.h"
+
+// for the alerts hold off
+#include "Time.h"
+
+/// Comparator modes
+#define ADC_COMP_GREATER (0)
+#define ADC_COMP_LESS    (1)
+
+/// Access the comparator registers by index
+#define ADC_COMP_REG(n) ((&ADC_COMP0_REG)[n])
+
+/// Buffer states
+enum
+{
+    /// Available for the acquisition
+    ADC_BUF_FREE = 0,
+    /// Being filled by the acquisition
+    ADC_BUF_FILL,
+    /// Full, waiting for the application
+    ADC_BUF_READY,
+    /// Processed by the application
+    ADC_BUF_BUSY
+};
+
+/// Window alert
+struct adc_alert
+{
+    /// Callback, NULL if the alert is disabled
+    adc_alert_t cb;
+
+    /// Window
+    uint16_t low;
+    uint16_t high;
+    uint16_t hyst;
+
+    /// Minimum time between two callbacks (RTC ticks)
+    uint32_t holdoff;
+
+    /// Date of the last callback
+    uint32_t last;
+
+    /// Channel
+    uint8_t channel;
+
+    /// Current zone
+    uint8_t zone;
+
+    /// A crossing was not reported yet because of the hold off
+    bool pending;
+};
+
+/// Acquisition environment
+static struct adc_env
+{
+    /// Samples
+    uint16_t buf[2][ADC_BUFFER_SIZE];
+
+    /// State of the buffers
+    volatile uint8_t state[2];
+
+    /// Buffer filled, or last filled when both are in use
+    uint8_t fill;
+
+    /// Number of samples in the buffer filled
+    uint8_t count;
+
+    /// Next buffer to give to the application
+    uint8_t get;
+
+    /// Number of samples dropped
+    uint32_t overruns;
+
+    /// Callback when a buffer is full
+    void (*ready)(void);
+
+    /// Window alerts
+    struct adc_alert alerts[ADC_ALERTS];
+} adc_env;
+
+/**
+ * Program a comparator.
+ * @param[in] n Comparator
+ * @param[in] mode ADC_COMP_GREATER or ADC_COMP_LESS
+ * @param[in] channel Channel
+ * @param[in] value Value compared to the conversions
+ */
+static void
+AdcComp(uint8_t n, uint8_t mode, uint8_t channel, uint16_t value)
+{
+    ADC_COMP_REG(n) = (mode << COMP0_GL_POS) | (channel << COMP0_CHANNEL_LSB) |
+            (value << COMP0_VALUE_LSB);
+}
+
+/**
+ * Program the comparators of an alert to detect when the channel leaves its zone.
+ * @param[in] i Alert
+ */
+static void
+AdcAlertArm(uint8_t i)
+{
+    struct adc_alert *alert = &adc_env.alerts[i];
+
+    switch (alert->zone)
+    {
+    case ADC_ZONE_INSIDE:
+        AdcComp(2 * i, ADC_COMP_GREATER, alert->channel, alert->high);
+        AdcComp(2 * i + 1, ADC_COMP_LESS, alert->channel, alert->low);
+        break;
+
+    case ADC_ZONE_ABOVE:
+        // back inside the window minus the hysteresis, the second comparator can not
+        // trigger (less than 0)
+        AdcComp(2 * i, ADC_COMP_LESS, alert->channel, alert->high - alert->hyst);
+        AdcComp(2 * i + 1, ADC_COMP_LESS, alert->channel, 0);
+        break;
+
+    case ADC_ZONE_BELOW:
+        AdcComp(2 * i, ADC_COMP_GREATER, alert->channel, alert->low + alert->hyst);
+        AdcComp(2 * i + 1, ADC_COMP_LESS, alert->channel, 0);
+        break;
+    }
+}
+
+/**
+ * Report the zone of an alert unless it is held off.
+ * @param[in] i Alert
+ */
+static void
+AdcAlertReport(uint8_t i)
+{
+    struct adc_alert *alert = &adc_env.alerts[i];
+    uint32_t now = TimeGet();
+
+    if ((uint32_t) TimeDiff(now, alert->last) < alert->holdoff)
+    {
+        alert->pending = true;
+        return;
+    }
+
+    alert->pending = false;
+    alert->last = now;
+    alert->cb(i, alert->zone);
+}
+
+/**
+ * Handle the comparators interrupt and the reports held off.
+ */
+static void
+AdcAlertInt(void)
+{
+    struct adc_alert *alert;
+    uint8_t i, trig = 0;
+
+    if (adc_irq_get() & COMPARE_BIT)
+    {
+        trig = adc_comp_getf();
+        adc_irq_set(COMPARE_BIT);
+    }
+
+    for (i = 0; i < ADC_ALERTS; i++, trig >>= 2)
+    {
+        alert = &adc_env.alerts[i];
+        if (!alert->cb)
+        {
+            continue;
+        }
+
+        if (trig & 3)
+        {
+            // the first comparator leaves the window upwards or re-enters it, the second
+            // one leaves it downwards
+            if (alert->zone != ADC_ZONE_INSIDE)
+            {
+                alert->zone = ADC_ZONE_INSIDE;
+            }
+            else if (trig & 1)
+            {
+                alert->zone = ADC_ZONE_ABOVE;
+            }
+            else
+            {
+                alert->zone = ADC_ZONE_BELOW;
+            }
+            AdcAlertArm(i);
+            AdcAlertReport(i);
+        }
+        else if (alert->pending)
+        {
+            AdcAlertReport(i);
+        }
+    }
+}
+
+void
+AdcInit(void)
+{
+    // ADC configuration
+    //  + prescale = 23 -> prescale clock = 1MHz (sequencer timers unit)
+    //  + clock_divider = 80 -> ADC clock = 300kHz
+    //  + on time = 10 * 1MHz = 10 us
+    //  + ADC on, voltage ref is VBAT, interrupts masked
+    //  + sequencers in control of the ADC
+    adc_control_pack(1, 1, 1, 1, 0, 0, 0, 0, 0, 1);
+    adc_clock_divider_set(80);
+    adc_prescale_set(23);
+    adc_on_time_set(10);
+    adc_convert_time_set(20);
+    adc_mode_set(0);
+}
+
+void
+AdcStart(uint8_t channels, uint32_t period, void (*ready)(void))
+{
+    AdcStop();
+
+    adc_env.state[0] = ADC_BUF_FILL;
+    adc_env.state[1] = ADC_BUF_FREE;
+    adc_env.fill = 0;
+    adc_env.count = 0;
+    adc_env.get = 0;
+    adc_env.overruns = 0;
+    adc_env.ready = ready;
+
+    // sequencer 1 converts the channels upon its timer event, every period
+    adc_sr_1_high_set(period >> 16);
+    adc_sr_1_low_set(period & 0xFFFF);
+    adc_seq1_pack(1, 0, channels);
+
+    // interrupt when the FIFO reaches the threshold
+    adc_fifo_control_set(ADC_FIFO_THRESHOLD);
+    adc_irq_set(FIFO_BIT);
+    adc_fifo_irq_mask_setf(0);
+
+    adc_timer1_on_setf(1);
+}
+
+void
+AdcStop(void)
+{
+    adc_timer1_on_setf(0);
+    adc_fifo_irq_mask_setf(1);
+
+    // flush the FIFO
+    while (!adc_fifo_status_empty_getf())
+    {
+        adc_fifo_read_get();
+    }
+    adc_irq_set(FIFO_BIT);
+}
+
+uint16_t const *
+AdcBufferGet(void)
+{
+    uint8_t i = adc_env.get;
+
+    // the buffers are filled alternately, and given in the same order
+    if (adc_env.state[i] != ADC_BUF_READY)
+    {
+        return NULL;
+    }
+    adc_env.state[i] = ADC_BUF_BUSY;
+    adc_env.get = i ^ 1;
+
+    return adc_env.buf[i];
+}
+
+void
+AdcBufferRelease(uint16_t const *samples)
+{
+    adc_env.state[(samples == adc_env.buf[0]) ? 0 : 1] = ADC_BUF_FREE;
+}
+
+uint32_t
+AdcOverruns(void)
+{
+    return adc_env.overruns;
+}
+
+void
+AdcAlertSet(uint8_t alert, uint8_t channel, uint16_t low, uint16_t high, uint16_t hyst,
+        uint16_t holdoff, adc_alert_t cb)
+{
+    struct adc_alert *a = &adc_env.alerts[alert];
+
+    adc_compare_irq_mask_setf(1);
+
+    // the comparators take 12 bits values: high - hyst and low + hyst must not wrap
+    if (high > ADC_VALUE_MAX)
+    {
+        high = ADC_VALUE_MAX;
+    }
+    if (low > high)
+    {
+        low = high;
+    }
+    if (hyst > (high - low))
+    {
+        hyst = high - low;
+    }
+
+    a->channel = channel;
+    a->low = low;
+    a->high = high;
+    a->hyst = hyst;
+    a->holdoff = TimeMsToTicks(holdoff);
+    a->last = TimeGet() - a->holdoff;
+    a->zone = ADC_ZONE_INSIDE;
+    a->pending = false;
+    a->cb = cb;
+    AdcAlertArm(alert);
+
+    adc_irq_set(COMPARE_BIT);
+    adc_compare_irq_mask_setf(0);
+}
+
+void
+AdcAlertClear(uint8_t alert)
+{
+    uint8_t i;
+
+    adc_env.alerts[alert].cb = NULL;
+    AdcComp(2 * alert, ADC_COMP_LESS, 0, 0);
+    AdcComp(2 * alert + 1, ADC_COMP_LESS, 0, 0);
+
+    // mask the comparators interrupt when no alert is left
+    for (i = 0; i < ADC_ALERTS; i++)
+    {
+        if (adc_env.alerts[i].cb)
+        {
+            return;
+        }
+    }
+    adc_compare_irq_mask_setf(1);
+}
+
+void
+AdcInt(void)
+{
+    bool full = false;
+    uint16_t sample;
+
+    AdcAlertInt();
+
+    while (!adc_fifo_status_empty_getf())
+    {
+        sample = adc_fifo_read_get();
+
+        if (adc_env.state[adc_env.fill] != ADC_BUF_FILL)
+        {
+            // the buffer is full, continue in the other one if the application gave it
+            // back, otherwise the sample is lost
+            if (adc_env.state[adc_env.fill ^ 1] != ADC_BUF_FREE)
+            {
+                adc_env.overruns++;
+                continue;
+            }
+            adc_env.fill ^= 1;
+            adc_env.state[adc_env.fill] = ADC_BUF_FILL;
+            adc_env.count = 0;
+        }
+
+        adc_env.buf[adc_env.fill][adc_env.count++] = sample;
+        if (adc_env.count == ADC_BUFFER_SIZE)
+        {
+            adc_env.state[adc_env.fill] = ADC_BUF_READY;
+            full = true;
+        }
+    }
+
+    // clear the FIFO interrupt once below the threshold
+    adc_irq_set(FIFO_BIT);
+
+    if (full && adc_env.ready)
+    {
+        adc_env.ready();
+    }
+}
@@ -0,0 +1,150 @@
+/*
+ * ADC acquisition API
+ *
+ * The sequencer 1 timer triggers the conversion of a set of channels periodically, the
+ * results are queued in the hardware FIFO.  The FIFO interrupt drains the FIFO into two
+ * RAM buffers used alternately: while one buffer is filled, the other one is processed
+ * by the application.
+ *
+ * The hardware comparators check each conversion against a window per alert: the
+ * alert callback is only called when the channel leaves or re-enters the window.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ADC_H_
+#define _ADC_H_
+
+// standard includes
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/// Number of samples in a buffer
+#define ADC_BUFFER_SIZE (64)
+
+/// FIFO level raising the interrupt (the FIFO holds 8 samples)
+#define ADC_FIFO_THRESHOLD (4)
+
+/// Channel of a sample
+#define ADC_SAMPLE_CHANNEL(s) ((s) >> 12)
+
+/// Maximum value of a conversion (12 bits)
+#define ADC_VALUE_MAX (0xFFF)
+
+/// Value of a sample
+#define ADC_SAMPLE_VALUE(s)   ((s) & ADC_VALUE_MAX)
+
+/// Number of alerts, each one uses 2 of the 8 comparators
+#define ADC_ALERTS (4)
+
+/// Position of a channel relative to the window of an alert
+enum adc_zone
+{
+    ADC_ZONE_INSIDE = 0,
+    ADC_ZONE_ABOVE,
+    ADC_ZONE_BELOW
+};
+
+/**
+ * Callback upon window crossing.
+ * @param[in] alert Alert
+ * @param[in] zone New position of the channel
+ */
+typedef void (*adc_alert_t)(uint8_t alert, enum adc_zone zone);
+
+/**
+ * Initialize the ADC: conversion clocks, ADC on, interrupts masked.
+ * @warning Peripheral clock is expected to be 24MHz
+ */
+extern void
+AdcInit(void);
+
+/**
+ * Start converting a set of channels periodically.
+ *
+ * All the channels are converted upon each period, each sample holds its channel.
+ * @param[in] channels Bitfield of the channels to convert (bit n for channel n)
+ * @param[in] period Period between two conversions of the channels (microseconds)
+ * @param[in] ready Callback when a buffer is full, called from @ref AdcInt
+ * @warning The ADC interrupt must be enabled in the ITC and call @ref AdcInt.
+ */
+extern void
+AdcStart(uint8_t channels, uint32_t period, void (*ready)(void));
+
+/**
+ * Stop the conversions.  The samples in the FIFO are dropped.
+ */
+extern void
+AdcStop(void);
+
+/**
+ * Get the oldest full buffer, to be processed by the application.
+ * @return The ADC_BUFFER_SIZE samples of the buffer, NULL if no buffer is full
+ */
+extern uint16_t const *
+AdcBufferGet(void);
+
+/**
+ * Give a buffer back to the acquisition once processed.
+ * @param[in] samples Samples of the buffer returned by @ref AdcBufferGet
+ */
+extern void
+AdcBufferRelease(uint16_t const *samples);
+
+/**
+ * Get the number of samples dropped because no buffer was available.
+ * @return The number of samples dropped since @ref AdcStart
+ */
+extern uint32_t
+AdcOverruns(void);
+
+/**
+ * Configure an alert on a window of values of a channel.
+ *
+ * The channel is considered inside the window first.  It leaves the window when a
+ * conversion is above high or below low, and re-enters it when a conversion is hyst
+ * inside the window.  The limits are saturated to @ref ADC_VALUE_MAX, low to high, and
+ * the hysteresis to the width of the window, so that the re-entry values stay inside
+ * the window.  After a call, the callback is not called again for holdoff
+ * milliseconds: the last crossing during that time is reported once it is elapsed,
+ * upon the next ADC interrupt.
+ * @param[in] alert Alert, from 0 to ADC_ALERTS - 1
+ * @param[in] channel Channel, from 0 to 7, converted by @ref AdcStart
+ * @param[in] low Low limit of the window
+ * @param[in] high High limit of the window
+ * @param[in] hyst Hysteresis to re-enter the window
+ * @param[in] holdoff Minimum time between two callbacks (milliseconds)
+ * @param[in] cb Callback upon crossing, called from @ref AdcInt
+ */
+extern void
+AdcAlertSet(uint8_t alert, uint8_t channel, uint16_t low, uint16_t high, uint16_t hyst,
+        uint16_t holdoff, adc_alert_t cb);
+
+/**
+ * Disable an alert.
+ * @param[in] alert Alert
+ */
+extern void
+AdcAlertClear(uint8_t alert);
+
+/**
+ * Function to call upon ADC peripheral interrupt.
+ */
+extern void
+AdcInt(void);
+
+#endif // _ADC_H_
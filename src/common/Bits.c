@@ -0,0 +1,35 @@
+/*
+ * Bit utilities implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "Bits.h"
+
+// leading zeros of a byte, 8 for 0
+#define BITS_CLZ8_4(c) c, c, c, c
+#define BITS_CLZ8_16(c) BITS_CLZ8_4(c), BITS_CLZ8_4(c), BITS_CLZ8_4(c), BITS_CLZ8_4(c)
+#define BITS_CLZ8_64(c) BITS_CLZ8_16(c), BITS_CLZ8_16(c), BITS_CLZ8_16(c), BITS_CLZ8_16(c)
+
+uint8_t const bits_clz8[256] =
+{
+    8, 7, 6, 6, BITS_CLZ8_4(5),
+    BITS_CLZ8_4(4), BITS_CLZ8_4(4),
+    BITS_CLZ8_16(3), BITS_CLZ8_16(2), BITS_CLZ8_16(2),
+    BITS_CLZ8_64(1),
+    BITS_CLZ8_64(0), BITS_CLZ8_64(0)
+};
@@ -0,0 +1,241 @@
+/*
+ * Bit utilities API
+ *
+ * The count of leading zeros is selected at compile time with BITS_CLZ:
+ * - BITS_CLZ_SEQ: conditional instructions sequence (see PROC_CLZ), 15 instructions
+ * - BITS_CLZ_TABLE: two tests and a lookup in a 256 entries table
+ * - BITS_CLZ_NATIVE: clz instruction, only for the ARMv5 and above in ARM mode
+ * The native instruction is the default when available, the sequence otherwise (the
+ * table in Thumb mode, which has no conditional execution).  All the variants available
+ * for the target are compiled, dsp_bench measures them.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _BITS_H_
+#define _BITS_H_
+
+// standard includes
+#include <stdint.h>
+
+// for compiler specific directives
+#include "compiler.h"
+
+// for the instructions sequence
+#include "proc/proc.h"
+
+/// Variants of the count of leading zeros
+#define BITS_CLZ_SEQ    (0)
+#define BITS_CLZ_TABLE  (1)
+#define BITS_CLZ_NATIVE (2)
+#define BITS_CLZ_C      (3)
+
+/// The clz instruction exists from ARMv5, not in Thumb-1
+#if !defined(__thumb__) && (defined(__ARM_ARCH_5__) || defined(__ARM_ARCH_5T__) || \
+        defined(__ARM_ARCH_5E__) || defined(__ARM_ARCH_5TE__) || \
+        defined(__ARM_ARCH_5TEJ__) || defined(__ARM_ARCH_6__) || \
+        defined(__ARM_ARCH_6J__) || defined(__ARM_ARCH_6K__) || \
+        defined(__ARM_ARCH_6Z__) || defined(__ARM_ARCH_6ZK__) || \
+        defined(__ARM_ARCH_7A__) || defined(__ARM_ARCH_7R__))
+#define BITS_HAVE_CLZ
+#endif
+
+#ifndef BITS_CLZ
+#if !defined(__arm__)
+#define BITS_CLZ BITS_CLZ_C
+#elif defined(BITS_HAVE_CLZ)
+#define BITS_CLZ BITS_CLZ_NATIVE
+#elif defined(__thumb__)
+#define BITS_CLZ BITS_CLZ_TABLE
+#else
+#define BITS_CLZ BITS_CLZ_SEQ
+#endif
+#endif
+
+#if (BITS_CLZ == BITS_CLZ_SEQ) && (defined(__thumb__) || !defined(__arm__))
+#error "The instructions sequence needs the ARM mode"
+#endif
+
+#if (BITS_CLZ == BITS_CLZ_NATIVE) && !defined(BITS_HAVE_CLZ)
+#error "No clz instruction on this architecture"
+#endif
+
+/// Number of leading zeros of the bytes
+extern uint8_t const bits_clz8[256];
+
+#if defined(__arm__) && !defined(__thumb__)
+/**
+ * Count the leading zeros with the instructions sequence.
+ * @param[in] v Value, must not be 0
+ * @return Number of leading zeros
+ */
+__INLINE uint32_t BitsClzSeq(uint32_t v)
+{
+    uint32_t c;
+
+    PROC_CLZ(c, v);
+    return c;
+}
+#endif
+
+/**
+ * Count the leading zeros with the table.
+ * @param[in] v Value, must not be 0
+ * @return Number of leading zeros
+ */
+__INLINE uint32_t BitsClzTable(uint32_t v)
+{
+    uint32_t c = 0;
+
+    if (v < (1 << 16))
+    {
+        c = 16;
+        v <<= 16;
+    }
+    if (v < (1 << 24))
+    {
+        c += 8;
+        v <<= 8;
+    }
+
+    return c + bits_clz8[v >> 24];
+}
+
+/**
+ * Count the leading zeros in C, the same binary search as the instructions sequence
+ * for the other architectures (e.g. the host tests).
+ * @param[in] v Value, must not be 0
+ * @return Number of leading zeros
+ */
+__INLINE uint32_t BitsClzC(uint32_t v)
+{
+    uint32_t c = 0;
+
+    if (!(v >> 16))
+    {
+        c = 16;
+        v <<= 16;
+    }
+    if (!(v >> 24))
+    {
+        c += 8;
+        v <<= 8;
+    }
+    if (!(v >> 28))
+    {
+        c += 4;
+        v <<= 4;
+    }
+    if (!(v >> 30))
+    {
+        c += 2;
+        v <<= 2;
+    }
+
+    return c + !(v >> 31);
+}
+
+#ifdef BITS_HAVE_CLZ
+/**
+ * Count the leading zeros with the clz instruction.
+ * @param[in] v Value
+ * @return Number of leading zeros
+ */
+__INLINE uint32_t BitsClzNative(uint32_t v)
+{
+    uint32_t c;
+
+    __asm("CLZ %0, %1" : "=r"(c) : "r"(v));
+    return c;
+}
+#endif
+
+/**
+ * Count the leading zeros with the variant selected by BITS_CLZ.
+ * @param[in] v Value, must not be 0
+ * @return Number of leading zeros
+ */
+__INLINE uint32_t BitsClz(uint32_t v)
+{
+#if BITS_CLZ == BITS_CLZ_NATIVE
+    return BitsClzNative(v);
+#elif BITS_CLZ == BITS_CLZ_TABLE
+    return BitsClzTable(v);
+#elif BITS_CLZ == BITS_CLZ_C
+    return BitsClzC(v);
+#else
+    return BitsClzSeq(v);
+#endif
+}
+
+/**
+ * Find the first (least significant) bit set.
+ * @param[in] v Value
+ * @return Position of the bit plus one, 0 if no bit is set
+ */
+__INLINE uint32_t BitsFfs(uint32_t v)
+{
+    if (!v)
+    {
+        return 0;
+    }
+
+    // isolate the lowest bit
+    return 32 - BitsClz(v & -v);
+}
+
+/**
+ * Count the bits set.
+ * @param[in] v Value
+ * @return Number of bits set
+ */
+__INLINE uint32_t BitsPopcount(uint32_t v)
+{
+    v = v - ((v >> 1) & 0x55555555);
+    v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+    v = (v + (v >> 4)) & 0x0F0F0F0F;
+
+    // add the bytes in the top one
+    return (v * 0x01010101) >> 24;
+}
+
+/**
+ * Reverse the order of the bits.
+ * @param[in] v Value
+ * @return Value with bit 0 swapped with bit 31, bit 1 with bit 30...
+ */
+__INLINE uint32_t BitsRev32(uint32_t v)
+{
+    v = ((v >> 1) & 0x55555555) | ((v & 0x55555555) << 1);
+    v = ((v >> 2) & 0x33333333) | ((v & 0x33333333) << 2);
+    v = ((v >> 4) & 0x0F0F0F0F) | ((v & 0x0F0F0F0F) << 4);
+    v = ((v >> 8) & 0x00FF00FF) | ((v & 0x00FF00FF) << 8);
+
+    return (v >> 16) | (v << 16);
+}
+
+/**
+ * Reverse the order of the lowest bits, e.g. for the FFT indexes.
+ * @param[in] v Value, lower than 2^n
+ * @param[in] n Number of bits, 1 to 32
+ * @return Value with bit 0 swapped with bit n-1...
+ */
+__INLINE uint32_t BitsRev(uint32_t v, uint8_t n)
+{
+    return BitsRev32(v) >> (32 - n);
+}
+
+#endif // _BITS_H_
@@ -0,0 +1,154 @@
+/*
+ * Monotonic clock implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "Clock.h"
+
+// for the RTC
+#include "reg_crm.h"
+
+// for the channels allocation and the interrupt dispatch
+#include "Tmr.h"
+
+struct clock_env clock_env;
+
+/// Last synchronization point between the RTC and the clock
+static struct clock_sync
+{
+    /// RTC value
+    uint32_t rtc;
+
+    /// Clock value
+    uint64_t clock;
+
+    /// Number of clock ticks during 2^CLOCK_RTC_CAL_TICKS_LOG2 RTC ticks
+    uint32_t period;
+} clock_sync;
+
+/**
+ * Measure the RTC period against the clock, starting on an RTC edge.
+ */
+static void
+ClockMeasure(void)
+{
+    uint32_t rtc, start;
+
+    rtc = crm_rtc_count_get();
+    while (crm_rtc_count_get() == rtc) ;
+    start = ClockGet32();
+    rtc = crm_rtc_count_get();
+    while ((crm_rtc_count_get() - rtc) < (1 << CLOCK_RTC_CAL_TICKS_LOG2)) ;
+    clock_sync.period = ClockGet32() - start;
+}
+
+/**
+ * Callback upon TMR3 overflow, extends the counters.
+ * @param[in] ch Channel
+ * @param[in] events Events that occurred
+ */
+static void
+ClockOverflow(uint8_t ch, uint8_t events)
+{
+    clock_env.high++;
+}
+
+bool
+ClockInit(void)
+{
+    // the counters are stopped by their allocation
+    if (TmrAlloc(2) < 0)
+    {
+        return false;
+    }
+    if (TmrAlloc(3) < 0)
+    {
+        TmrRelease(2);
+        return false;
+    }
+
+    // configure timer 2:
+    //    - primary source = peripheral clock
+    //    - count repeatedly and reinitializes once compare reached
+    //    - count up
+    //    - no co_init and no OFLAG
+    tmr2_ctrl_pack(0, 8, 0, 0, 1, 0, 0, 0);
+    tmr2_sctrl_set(0);
+    tmr2_csctrl_set(0);
+    //    - count the 2^16 values
+    tmr2_load_set(0);
+    tmr2_comp1_set(0xFFFF);
+
+    // configure timer 3:
+    //    - primary source = counter2 output
+    //    - count repeatedly and roll over
+    //    - count up
+    //    - no co_init and no OFLAG
+    tmr3_ctrl_pack(0, 6, 0, 0, 0, 0, 0, 0);
+    //    - enable interrupt upon overflow
+    tmr3_sctrl_pack(0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    tmr3_csctrl_set(0);
+    tmr3_load_set(0);
+    tmr3_comp1_set(0xFFFF);
+    TmrSetCallback(3, ClockOverflow);
+
+    clock_env.high = 0;
+    clock_env.offset = 0;
+
+    // start timer 3 synchronous to timer 2, then timer 2 counting rising edges
+    tmr2_cntr_set(0);
+    tmr3_cntr_set(0);
+    tmr3_count_mode_setf(7);
+    tmr2_count_mode_setf(1);
+
+    // the RTC period is only needed by the resynchronization, it is measured then
+    clock_sync.period = 0;
+    clock_sync.rtc = crm_rtc_count_get();
+    clock_sync.clock = ClockGet();
+    return true;
+}
+
+void
+ClockResync(void)
+{
+    uint32_t rtc;
+    uint64_t now, elapsed;
+
+    if (!clock_sync.period)
+    {
+        ClockMeasure();
+    }
+
+    rtc = crm_rtc_count_get();
+    now = ClockGet();
+
+    // time elapsed since the last synchronization according to the RTC
+    elapsed = (((uint64_t) (rtc - clock_sync.rtc)) * clock_sync.period) >>
+            CLOCK_RTC_CAL_TICKS_LOG2;
+
+    // the RTC drifts with the temperature, only consider that the counters were stopped
+    // when they missed more than 1/16 of the elapsed time
+    if ((clock_sync.clock + elapsed) > (now + (elapsed >> 4)))
+    {
+        clock_env.offset += clock_sync.clock + elapsed - now;
+        now = clock_sync.clock + elapsed;
+    }
+
+    clock_sync.rtc = rtc;
+    clock_sync.clock = now;
+}
@@ -0,0 +1,140 @@
+/*
+ * Monotonic clock API
+ *
+ * The clock counts the 24MHz peripheral clock on the cascade of TMR2 (low 16 bits)
+ * and TMR3 (high 16 bits).  The TMR3 overflow interrupt extends it to 64 bits.  The
+ * TMR does not count when the peripheral clock is stopped, the RTC is then used to
+ * account for the time spent sleeping (@ref ClockResync).
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+// standard includes
+#include <stdint.h>
+#include <stdbool.h>
+
+// for compiler specific directives
+#include "compiler.h"
+
+// for the counters
+#include "reg_tmr2.h"
+#include "reg_tmr3.h"
+
+/// Frequency of the clock (Hz)
+#define CLOCK_FREQ (24000000)
+
+/// Convert microseconds to clock ticks
+#define CLOCK_US(us) ((us) * (CLOCK_FREQ / 1000000))
+
+/// Number of RTC ticks used to measure the RTC period against the clock
+#define CLOCK_RTC_CAL_TICKS_LOG2 (6)
+
+/// Clock environment, only accessed directly by the inline functions
+struct clock_env
+{
+    /// Bits 63-32 of the counters, incremented upon TMR3 overflow
+    volatile uint32_t high;
+
+    /// Time spent with the counters stopped, added to the counters value
+    uint64_t offset;
+};
+
+extern struct clock_env clock_env;
+
+/**
+ * Initialize the clock and start counting from 0.
+ *
+ * TMR2 and TMR3 are allocated to the clock.  The RTC period is measured against the
+ * clock by the first @ref ClockResync, which takes 64 RTC ticks more, so that the
+ * boot does not wait for it.
+ * @warning Peripheral clock is expected to be 24MHz, the RTC must be running, and the
+ * TMR interrupt must be enabled in the ITC and call @ref TmrInt to extend the clock
+ * beyond 32 bits (179 seconds).
+ * @return true if TMR2 and TMR3 were allocated, the clock must not be used otherwise
+ */
+extern bool
+ClockInit(void);
+
+/**
+ * Account for the time during which the counters were stopped.
+ *
+ * The time elapsed since the previous call according to the RTC is compared to the
+ * time elapsed according to the clock, and the clock is moved forward by the
+ * difference.  To be called after a wake up from a low power mode, and at least once
+ * every 2^32 RTC ticks.  The first call measures the RTC period (64 RTC ticks).
+ */
+extern void
+ClockResync(void);
+
+/**
+ * Get the lower 32 bits of the clock, for short durations.
+ *
+ * The counters are read until TMR3 does not change while reading TMR2.
+ * @return The current clock value, modulo 2^32.
+ */
+__INLINE uint32_t ClockGet32(void)
+{
+    uint16_t high, low;
+
+    do
+    {
+        high = tmr3_cntr_get();
+        low = tmr2_cntr_get();
+    } while (high != tmr3_cntr_get());
+
+    return (((uint32_t) high) << 16) | low;
+}
+
+/**
+ * Get the clock.
+ * @return The number of clock ticks since @ref ClockInit.
+ */
+__INLINE uint64_t ClockGet(void)
+{
+    uint32_t high, low;
+    uint8_t pending;
+
+    do
+    {
+        high = clock_env.high;
+        low = ClockGet32();
+        pending = tmr3_tof_getf();
+    } while (high != clock_env.high);
+
+    // the overflow happened before the counters were read but was not handled yet
+    if (pending && (low < 0x80000000))
+    {
+        high++;
+    }
+
+    return ((((uint64_t) high) << 32) | low) + clock_env.offset;
+}
+
+/**
+ * Convert a number of clock ticks to microseconds.
+ * @param[in] ticks Number of clock ticks
+ * @return Number of microseconds
+ */
+__INLINE uint32_t ClockTicksToUs(uint32_t ticks)
+{
+    // divide by 24: multiply by 2^36/24 rounded up, then divide by 2^36
+    return (uint32_t) ((((uint64_t) ticks) * 0xAAAAAAABU) >> 36);
+}
+
+#endif // _CLOCK_H_
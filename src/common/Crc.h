@@ -0,0 +1,44 @@
+/*
+ * CRC API
+ *
+ * The reads are served from a few RAM lines filled with NVM_Read.  The least recently
+ * used line is replaced on a miss, and a miss following an access to the previous
+ * line also fetches the next line in the same NVM_Read.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _CRC_H_
+#define _CRC_H_
+
+// standard includes
+#include <stdint.h>
+
+/// Initial value of a CRC32, the final value is the CRC inverted
+#define CRC32_INIT (0xFFFFFFFF)
+
+/**
+ * Update a CRC32 with a buffer (same CRC as zlib, the initial value being
+ * @ref CRC32_INIT and the final value being inverted).
+ * @param[in] crc Current value of the CRC
+ * @param[in] buf Buffer to add to the CRC
+ * @param[in] len Length of the buffer
+ * @return Updated value of the CRC
+ */
+extern uint32_t
+Crc32(uint32_t crc, void const *buf, uint32_t len);
+
+#endif // _CRC_H_
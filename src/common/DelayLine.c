@@ -0,0 +1,301 @@
+/*
+ * Edges delay line implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "DelayLine.h"
+
+// for the TMR channels
+#include "Tmr.h"
+
+// for the fields of the registers (identical for all the channels), and the channels
+// enable register
+#include "reg_tmr0.h"
+
+// for the critical sections
+#include "proc/proc.h"
+
+/// Output modes driving OFLAG to a level upon compare
+#define DELAY_LINE_OUTPUT_CLEAR (1)
+#define DELAY_LINE_OUTPUT_SET   (2)
+
+/// Edge in flight
+struct delay_line_edge
+{
+    /// Date of the input edge
+    uint16_t date;
+
+    /// Date of the output edge
+    uint16_t target;
+
+    /// Level after the edge
+    uint8_t level;
+};
+
+/// Delay line environment
+static struct delay_line_env
+{
+    /// Channels
+    uint8_t in;
+    uint8_t out;
+
+    /// Delay applied to the captured edges
+    uint16_t delay;
+
+    /// Level of the input after the last captured edge, the capture is armed for the
+    /// opposite edge only
+    uint8_t level;
+
+    /// Edges in flight, the oldest one is programmed in the output compare
+    struct delay_line_edge edges[DELAY_LINE_EDGES];
+    uint8_t first;
+    uint8_t count;
+
+    /// Statistics
+    struct delay_line_stats stats;
+} delay_line_env;
+
+/**
+ * Account for an edge reproduced.
+ * @param[in] edge Edge reproduced
+ * @param[in] date Measured date of the output edge
+ */
+static void
+DelayLineDone(struct delay_line_edge const *edge, uint16_t date)
+{
+    uint16_t delay = date - edge->date;
+    uint16_t error = date - edge->target;
+
+    delay_line_env.stats.edges++;
+    if (delay < delay_line_env.stats.min_delay)
+    {
+        delay_line_env.stats.min_delay = delay;
+    }
+    if (delay > delay_line_env.stats.max_delay)
+    {
+        delay_line_env.stats.max_delay = delay;
+    }
+    if (error > delay_line_env.stats.max_error)
+    {
+        delay_line_env.stats.max_error = error;
+    }
+
+    delay_line_env.first = (delay_line_env.first + 1) & (DELAY_LINE_EDGES - 1);
+    delay_line_env.count--;
+}
+
+/**
+ * Program the output compare with the oldest edge in flight.
+ *
+ * The edges whose date is already passed are reproduced immediately.
+ */
+static void
+DelayLineProgram(void)
+{
+    struct tmr_regs *regs = TMR_REGS(delay_line_env.out);
+    struct delay_line_edge const *edge;
+    uint16_t now;
+
+    while (delay_line_env.count)
+    {
+        edge = &delay_line_env.edges[delay_line_env.first];
+
+        // drive the level of the edge upon compare and capture the edge on the output
+        // pin, clearing any previous compare and capture flags
+        regs->ctrl = (regs->ctrl & ~OUTPUT_MODE_MASK) | ((edge->level ?
+                DELAY_LINE_OUTPUT_SET : DELAY_LINE_OUTPUT_CLEAR) << OUTPUT_MODE_LSB);
+        regs->comp1 = edge->target;
+        regs->sctrl = ((regs->sctrl | TMR_SCTRL_FLAGS) &
+                ~(TCF_BIT | IEF_BIT | FORCE_BIT | CAPTURE_MODE_MASK)) | TCFIE_BIT |
+                ((edge->level ? TMR_EDGE_RISING : TMR_EDGE_FALLING) << CAPTURE_MODE_LSB);
+
+        // the counter is read before the flag: if the compare value is passed and the
+        // flag is not set, the compare was missed
+        now = regs->cntr;
+        if ((regs->sctrl & TCF_BIT) || ((int16_t) (edge->target - now) > 0))
+        {
+            return;
+        }
+
+        // force the output level now
+        regs->sctrl = ((regs->sctrl | TMR_SCTRL_FLAGS) & ~(TCF_BIT | TCFIE_BIT | VAL_BIT)) |
+                FORCE_BIT | (edge->level ? VAL_BIT : 0);
+        delay_line_env.stats.late++;
+        DelayLineDone(edge, now);
+    }
+
+    // nothing in flight
+    regs->sctrl = (regs->sctrl | TMR_SCTRL_FLAGS) & ~(TCF_BIT | TCFIE_BIT | FORCE_BIT);
+}
+
+/**
+ * Callback upon edge capture on the input channel.
+ * @param[in] ch Channel
+ * @param[in] events Events that occurred
+ */
+static void
+DelayLineCapture(uint8_t ch, uint8_t events)
+{
+    struct tmr_regs *regs = TMR_REGS(ch);
+    struct delay_line_edge *edge;
+    uint8_t level;
+
+    if (!(events & TMR_EVT_CAPTURE))
+    {
+        return;
+    }
+
+    // the capture was armed for the edge opposite to the last level, so the polarity
+    // of the edge is known whatever the input did since; then arm the opposite edge.
+    // An edge followed by the opposite one within the interrupt latency is not seen:
+    // the pulse is lost but the output keeps the polarity of the input
+    level = !delay_line_env.level;
+    delay_line_env.level = level;
+    regs->sctrl = ((regs->sctrl | TMR_SCTRL_FLAGS) & ~CAPTURE_MODE_MASK) |
+            ((level ? TMR_EDGE_FALLING : TMR_EDGE_RISING) << CAPTURE_MODE_LSB);
+
+    if (delay_line_env.count == DELAY_LINE_EDGES)
+    {
+        delay_line_env.stats.dropped++;
+        return;
+    }
+
+    edge = &delay_line_env.edges[(delay_line_env.first + delay_line_env.count) &
+            (DELAY_LINE_EDGES - 1)];
+    edge->date = regs->capt;
+    edge->target = edge->date + delay_line_env.delay;
+    edge->level = level;
+    delay_line_env.count++;
+
+    // the first edge in flight is programmed right away
+    if (delay_line_env.count == 1)
+    {
+        DelayLineProgram();
+    }
+}
+
+/**
+ * Callback upon compare on the output channel, the edge was generated.
+ * @param[in] ch Channel
+ * @param[in] events Events that occurred
+ */
+static void
+DelayLineCompare(uint8_t ch, uint8_t events)
+{
+    struct tmr_regs *regs = TMR_REGS(ch);
+    struct delay_line_edge const *edge;
+    uint16_t date;
+
+    if (!(events & TMR_EVT_COMPARE) || !delay_line_env.count)
+    {
+        return;
+    }
+
+    // date of the edge captured on the output pin, else the counter read now is a late
+    // bound of it
+    date = (regs->sctrl & IEF_BIT) ? regs->capt : regs->cntr;
+
+    edge = &delay_line_env.edges[delay_line_env.first];
+    DelayLineDone(edge, date);
+    DelayLineProgram();
+}
+
+/**
+ * Reset the statistics.
+ */
+static void
+DelayLineStatsReset(void)
+{
+    delay_line_env.stats.edges = 0;
+    delay_line_env.stats.late = 0;
+    delay_line_env.stats.dropped = 0;
+    delay_line_env.stats.min_delay = 0xFFFF;
+    delay_line_env.stats.max_delay = 0;
+    delay_line_env.stats.max_error = 0;
+}
+
+bool
+DelayLineStart(uint8_t in, uint8_t out, uint8_t src, uint16_t delay)
+{
+    struct tmr_regs *regs;
+    uint8_t level;
+
+    if (TmrAlloc(in) < 0)
+    {
+        return false;
+    }
+    if (TmrAlloc(out) < 0)
+    {
+        TmrRelease(in);
+        return false;
+    }
+
+    delay_line_env.in = in;
+    delay_line_env.out = out;
+    DelayLineSet(delay);
+    delay_line_env.first = 0;
+    delay_line_env.count = 0;
+    DelayLineStatsReset();
+
+    // hold both channels until they are configured
+    tmr0_enbl_set(tmr0_enbl_get() & ~((1 << in) | (1 << out)));
+
+    // input channel: capture the edge leaving the current level, the polarity alternates
+    // from there
+    TmrStartCapture(in, src, TMR_EDGE_RISING, DelayLineCapture);
+    regs = TMR_REGS(in);
+    level = (regs->sctrl & INPUT_BIT) ? 1 : 0;
+    delay_line_env.level = level;
+    regs->sctrl = ((regs->sctrl | TMR_SCTRL_FLAGS) & ~CAPTURE_MODE_MASK) |
+            ((level ? TMR_EDGE_FALLING : TMR_EDGE_RISING) << CAPTURE_MODE_LSB);
+
+    // output channel: count repeatedly and roll over, the output at the input level, its
+    // own pin as secondary source to capture the generated edges
+    regs = TMR_REGS(out);
+    regs->sctrl = OEN_BIT | FORCE_BIT | (level ? VAL_BIT : 0);
+    regs->ctrl = (1 << COUNT_MODE_LSB) | (src << PRIMARY_CNT_SOURCE_LSB) |
+            (out << SECONDARY_CNT_SOURCE_LSB) |
+            ((level ? DELAY_LINE_OUTPUT_SET : DELAY_LINE_OUTPUT_CLEAR) << OUTPUT_MODE_LSB);
+    TmrSetCallback(out, DelayLineCompare);
+
+    // start both counters from 0 at the same time
+    TMR_REGS(in)->cntr = 0;
+    regs->cntr = 0;
+    tmr0_enbl_set(tmr0_enbl_get() | (1 << in) | (1 << out));
+
+    return true;
+}
+
+void
+DelayLineSet(uint16_t delay)
+{
+    if (delay > DELAY_LINE_MAX)
+    {
+        delay = DELAY_LINE_MAX;
+    }
+    delay_line_env.delay = delay;
+}
+
+void
+DelayLineStats(struct delay_line_stats *stats)
+{
+    PROC_INT_DISABLE();
+    *stats = delay_line_env.stats;
+    DelayLineStatsReset();
+    PROC_INT_RESTORE();
+}
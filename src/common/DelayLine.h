@@ -0,0 +1,94 @@
+/*
+ * Edges delay line API
+ *
+ * The edges on the input pin of a TMR channel are reproduced on the output pin of
+ * another channel after a programmable delay.  The input channel captures the date of
+ * each edge, the output channel compare drives the output level at the date plus the
+ * delay, so neither depends on the interrupt latency.  Several edges can be in flight
+ * when the delay is longer than the interval between edges.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DELAY_LINE_H_
+#define _DELAY_LINE_H_
+
+// standard includes
+#include <stdint.h>
+#include <stdbool.h>
+
+/// Number of edges in flight (power of 2)
+#define DELAY_LINE_EDGES (16)
+
+/// Maximum delay in counter source ticks
+#define DELAY_LINE_MAX (0x7FFF)
+
+/// Delay line statistics
+struct delay_line_stats
+{
+    /// Number of edges reproduced
+    uint32_t edges;
+
+    /// Number of edges reproduced later than programmed, because the compare value was
+    /// already passed when it was programmed
+    uint32_t late;
+
+    /// Number of edges lost because too many were in flight
+    uint32_t dropped;
+
+    /// Minimum and maximum delay measured between an input and an output edge (ticks)
+    uint16_t min_delay;
+    uint16_t max_delay;
+
+    /// Maximum difference between the measured and the programmed delays (ticks), the
+    /// output edges are captured on the output pin
+    uint16_t max_error;
+};
+
+/**
+ * Allocate the channels and start reproducing the edges.
+ *
+ * The output starts at the level of the input.  Both channels count the same source,
+ * and are started together so that the dates of both counters match.  The input
+ * capture alternates between the rising and the falling edge, which gives the level
+ * of each edge.
+ * @param[in] in Channel capturing the edges (the pin must be configured for the TMR
+ * function)
+ * @param[in] out Channel generating the edges (the pin must be configured for the TMR
+ * function)
+ * @param[in] src Counter source (TMR_SRC_*)
+ * @param[in] delay Delay in counter source ticks, up to DELAY_LINE_MAX
+ * @return true if the channels were allocated
+ * @warning The TMR interrupt must be enabled in the ITC and call @ref TmrInt.
+ */
+extern bool
+DelayLineStart(uint8_t in, uint8_t out, uint8_t src, uint16_t delay);
+
+/**
+ * Change the delay, for the edges captured from now on.
+ * @param[in] delay Delay in counter source ticks, up to DELAY_LINE_MAX
+ */
+extern void
+DelayLineSet(uint16_t delay);
+
+/**
+ * Get the statistics, and reset them.
+ * @param[out] stats Statistics since the previous call
+ */
+extern void
+DelayLineStats(struct delay_line_stats *stats);
+
+#endif // _DELAY_LINE_H_
@@ -0,0 +1,343 @@
+/*
+ * Fixed-point signal processing implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "Dsp.h"
+
+/// sin(2 * pi * k / 64) for k = 0 to 16 (Q15), the other twiddle factors are derived
+static q15_t const dsp_sin[17] =
+{
+    0, 3212, 6393, 9512, 12539, 15446, 18204, 20787, 23170,
+    25329, 27245, 28898, 30273, 31356, 32137, 32609, 32767
+};
+
+/**
+ * Saturate a value to the Q15 range.
+ * @param[in] x Value
+ * @return The saturated value
+ */
+static q15_t
+DspSat(int32_t x)
+{
+    if (x > 32767)
+    {
+        return 32767;
+    }
+    if (x < -32768)
+    {
+        return -32768;
+    }
+    return x;
+}
+
+/**
+ * Dot product of the coefficients and the samples of a FIR filter.
+ *
+ * The loop is unrolled by 4 so that the 16 bits loads and the MLA instructions are
+ * interleaved without the loop overhead.
+ * @param[in] c Coefficients (Q15)
+ * @param[in] x Samples, newest first
+ * @param[in] taps Number of taps
+ * @return The output sample
+ */
+static q15_t
+DspDot(q15_t const *c, q15_t const *x, uint8_t taps)
+{
+    int32_t acc = 1 << 14;
+    uint8_t k;
+
+    for (k = taps >> 2; k; k--)
+    {
+        acc += c[0] * x[0];
+        acc += c[1] * x[1];
+        acc += c[2] * x[2];
+        acc += c[3] * x[3];
+        c += 4;
+        x += 4;
+    }
+    for (k = taps & 3; k; k--)
+    {
+        acc += *c++ * *x++;
+    }
+
+    return DspSat(acc >> 15);
+}
+
+/**
+ * Get a twiddle factor W = exp(-2i * pi * m / 64) = c - i * s.
+ * @param[in] m Index of the factor, from 0 to 31
+ * @param[out] c Cosine (Q15)
+ * @param[out] s Sine (Q15)
+ */
+static void
+DspTwiddle(uint32_t m, int32_t *c, int32_t *s)
+{
+    if (m <= 16)
+    {
+        *c = dsp_sin[16 - m];
+        *s = dsp_sin[m];
+    }
+    else
+    {
+        *c = -dsp_sin[m - 16];
+        *s = dsp_sin[32 - m];
+    }
+}
+
+void
+DspFirInit(struct dsp_fir *fir, q15_t const *coefs, q15_t *state, uint8_t taps)
+{
+    uint16_t i;
+
+    fir->coefs = coefs;
+    fir->state = state;
+    fir->taps = taps;
+    fir->pos = 0;
+    fir->phase = 1;
+    for (i = 0; i < (2 * taps); i++)
+    {
+        state[i] = 0;
+    }
+}
+
+uint32_t
+DspFir(struct dsp_fir *fir, q15_t const *in, q15_t *out, uint32_t n, uint8_t decim)
+{
+    q15_t *state = fir->state;
+    uint8_t taps = fir->taps;
+    uint8_t pos = fir->pos;
+    uint32_t i, count = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        // the newest sample is stored twice so that the window is always contiguous
+        pos = pos ? (pos - 1) : (taps - 1);
+        state[pos] = in[i];
+        state[pos + taps] = in[i];
+
+        // only compute the output samples that are kept
+        if (--fir->phase)
+        {
+            continue;
+        }
+        fir->phase = decim;
+        out[count++] = DspDot(fir->coefs, &state[pos], taps);
+    }
+
+    fir->pos = pos;
+    return count;
+}
+
+void
+DspBiquadInit(struct dsp_biquad *bq, int16_t b0, int16_t b1, int16_t b2, int16_t a1,
+        int16_t a2)
+{
+    bq->coefs[0] = b0;
+    bq->coefs[1] = b1;
+    bq->coefs[2] = b2;
+    bq->coefs[3] = a1;
+    bq->coefs[4] = a2;
+    bq->x1 = 0;
+    bq->x2 = 0;
+    bq->y1 = 0;
+    bq->y2 = 0;
+}
+
+void
+DspBiquad(struct dsp_biquad *bq, uint8_t stages, q15_t const *in, q15_t *out,
+        uint32_t n)
+{
+    int32_t b0, b1, b2, a1, a2, x1, x2, y1, y2, x;
+    int64_t acc;
+    uint32_t i;
+
+    for (; stages; stages--, bq++)
+    {
+        // keep the section in registers for the whole buffer
+        b0 = bq->coefs[0];
+        b1 = bq->coefs[1];
+        b2 = bq->coefs[2];
+        a1 = bq->coefs[3];
+        a2 = bq->coefs[4];
+        x1 = bq->x1;
+        x2 = bq->x2;
+        y1 = bq->y1;
+        y2 = bq->y2;
+
+        for (i = 0; i < n; i++)
+        {
+            x = in[i];
+
+            // 64 bits accumulation (SMLAL), the feedback terms can exceed 32 bits
+            acc = 1 << 13;
+            acc += (int64_t) b0 * x;
+            acc += (int64_t) b1 * x1;
+            acc += (int64_t) b2 * x2;
+            acc -= (int64_t) a1 * y1;
+            acc -= (int64_t) a2 * y2;
+
+            x2 = x1;
+            x1 = x;
+            y2 = y1;
+            y1 = DspSat((int32_t) (acc >> 14));
+            out[i] = y1;
+        }
+
+        bq->x1 = x1;
+        bq->x2 = x2;
+        bq->y1 = y1;
+        bq->y2 = y2;
+
+        // the next section filters the output of this one
+        in = out;
+    }
+}
+
+void
+DspRmsInit(struct dsp_rms *rms, q15_t *window, uint8_t log2)
+{
+    uint16_t i;
+
+    rms->window = window;
+    rms->log2 = log2;
+    rms->pos = 0;
+    rms->sum = 0;
+    for (i = 0; i < (1 << log2); i++)
+    {
+        window[i] = 0;
+    }
+}
+
+q15_t
+DspRms(struct dsp_rms *rms, q15_t x)
+{
+    q15_t old = rms->window[rms->pos];
+    uint32_t root;
+
+    rms->window[rms->pos] = x;
+    rms->pos = (rms->pos + 1) & ((1 << rms->log2) - 1);
+
+    // the squares are kept in Q22 so that 512 of them fit in 32 bits
+    rms->sum += ((int32_t) x * x) >> 8;
+    rms->sum -= ((int32_t) old * old) >> 8;
+
+    root = DspSqrt((rms->sum >> rms->log2) << 8);
+    return (root > 32767) ? 32767 : root;
+}
+
+void
+DspStats(q15_t const *in, uint8_t log2, struct dsp_stats *stats)
+{
+    q15_t min = 32767, max = -32768, x;
+    int32_t sum = 0;
+    uint32_t i;
+
+    for (i = 0; i < (1UL << log2); i++)
+    {
+        x = in[i];
+        sum += x;
+        if (x < min)
+        {
+            min = x;
+        }
+        if (x > max)
+        {
+            max = x;
+        }
+    }
+
+    stats->min = min;
+    stats->max = max;
+    stats->mean = sum >> log2;
+}
+
+void
+DspFft(struct dsp_complex *data, uint8_t log2)
+{
+    struct dsp_complex a, b;
+    uint32_t n = 1UL << log2;
+    uint32_t i, j, k, bit, half, step;
+    int32_t c, s, tr, ti;
+
+    // reorder the samples in bit reversed order
+    for (i = 1, j = 0; i < n; i++)
+    {
+        for (bit = n >> 1; j & bit; bit >>= 1)
+        {
+            j ^= bit;
+        }
+        j |= bit;
+        if (i < j)
+        {
+            a = data[i];
+            data[i] = data[j];
+            data[j] = a;
+        }
+    }
+
+    // radix-2 butterflies, the twiddle factors of 2 * half points are taken every
+    // step factors of the 64 points table
+    for (half = 1, step = 1 << (DSP_FFT_LOG2_MAX - 1); half < n; half <<= 1, step >>= 1)
+    {
+        for (k = 0; k < half; k++)
+        {
+            DspTwiddle(k * step, &c, &s);
+
+            for (i = k; i < n; i += 2 * half)
+            {
+                a = data[i];
+                b = data[i + half];
+
+                tr = (c * b.re + s * b.im) >> 15;
+                ti = (c * b.im - s * b.re) >> 15;
+
+                data[i].re = (a.re + tr) >> 1;
+                data[i].im = (a.im + ti) >> 1;
+                data[i + half].re = (a.re - tr) >> 1;
+                data[i + half].im = (a.im - ti) >> 1;
+            }
+        }
+    }
+}
+
+uint16_t
+DspSqrt(uint32_t x)
+{
+    uint32_t root = 0, bit = 1UL << 30;
+
+    while (bit > x)
+    {
+        bit >>= 2;
+    }
+    while (bit)
+    {
+        if (x >= (root + bit))
+        {
+            x -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return root;
+}
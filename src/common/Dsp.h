@@ -0,0 +1,192 @@
+/*
+ * Fixed-point signal processing API
+ *
+ * The samples are signed Q15 values (-1.0 to 1.0 - 2^-15).  The blocks work on buffers
+ * of samples to amortize the calls, and only use multiply-accumulate (MLA, SMLAL) and
+ * constant shifts so that they do not need any run-time support (no division, no
+ * floating point).
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _DSP_H_
+#define _DSP_H_
+
+// standard includes
+#include <stdint.h>
+
+/// Q15 sample
+typedef int16_t q15_t;
+
+/// Maximum log2 of the number of points of @ref DspFft
+#define DSP_FFT_LOG2_MAX (6)
+
+/// FIR filter
+struct dsp_fir
+{
+    /// Coefficients (Q15), the sum of their absolute values must be below 2.0
+    q15_t const *coefs;
+
+    /// Last input samples, twice the number of taps so that they are contiguous
+    q15_t *state;
+
+    /// Number of taps
+    uint8_t taps;
+
+    /// Index of the newest sample in the state
+    uint8_t pos;
+
+    /// Number of input samples before the next output sample, when decimating
+    uint8_t phase;
+};
+
+/// Biquad IIR filter section (direct form I)
+struct dsp_biquad
+{
+    /// Coefficients (Q14): b0, b1, b2, a1, a2 with a0 = 1.0
+    int16_t coefs[5];
+
+    /// Last input samples x[n-1], x[n-2] and output samples y[n-1], y[n-2]
+    q15_t x1, x2, y1, y2;
+};
+
+/// Moving RMS
+struct dsp_rms
+{
+    /// Last input samples, 2^log2 samples
+    q15_t *window;
+
+    /// Log2 of the window size, up to 9
+    uint8_t log2;
+
+    /// Index of the oldest sample in the window
+    uint16_t pos;
+
+    /// Sum of the squares of the samples in the window (Q22)
+    uint32_t sum;
+};
+
+/// Statistics of a window
+struct dsp_stats
+{
+    q15_t min;
+    q15_t max;
+    q15_t mean;
+};
+
+/// Complex Q15 sample
+struct dsp_complex
+{
+    q15_t re;
+    q15_t im;
+};
+
+/**
+ * Initialize a FIR filter, with a null history.
+ * @param[out] fir Filter
+ * @param[in] coefs Coefficients (Q15), must stay valid while used
+ * @param[in] state Storage for 2 * taps samples
+ * @param[in] taps Number of taps
+ */
+extern void
+DspFirInit(struct dsp_fir *fir, q15_t const *coefs, q15_t *state, uint8_t taps);
+
+/**
+ * Filter a buffer of samples with a FIR filter, keeping one output sample every
+ * decim input samples.
+ * @param[in,out] fir Filter
+ * @param[in] in Input samples
+ * @param[out] out Output samples, can be the input buffer
+ * @param[in] n Number of input samples
+ * @param[in] decim Decimation factor, 1 to filter only
+ * @return The number of output samples
+ */
+extern uint32_t
+DspFir(struct dsp_fir *fir, q15_t const *in, q15_t *out, uint32_t n, uint8_t decim);
+
+/**
+ * Initialize a biquad section, with a null history.
+ * @param[out] bq Section
+ * @param[in] b0 b0 coefficient (Q14)
+ * @param[in] b1 b1 coefficient (Q14)
+ * @param[in] b2 b2 coefficient (Q14)
+ * @param[in] a1 a1 coefficient (Q14)
+ * @param[in] a2 a2 coefficient (Q14)
+ */
+extern void
+DspBiquadInit(struct dsp_biquad *bq, int16_t b0, int16_t b1, int16_t b2, int16_t a1,
+        int16_t a2);
+
+/**
+ * Filter a buffer of samples with a cascade of biquad sections.
+ * @param[in,out] bq Sections
+ * @param[in] stages Number of sections
+ * @param[in] in Input samples
+ * @param[out] out Output samples, can be the input buffer
+ * @param[in] n Number of samples
+ */
+extern void
+DspBiquad(struct dsp_biquad *bq, uint8_t stages, q15_t const *in, q15_t *out,
+        uint32_t n);
+
+/**
+ * Initialize a moving RMS, with a window of null samples.
+ * @param[out] rms Moving RMS
+ * @param[in] window Storage for 2^log2 samples
+ * @param[in] log2 Log2 of the window size, up to 9
+ */
+extern void
+DspRmsInit(struct dsp_rms *rms, q15_t *window, uint8_t log2);
+
+/**
+ * Add a sample to a moving RMS.
+ * @param[in,out] rms Moving RMS
+ * @param[in] x Input sample
+ * @return The RMS of the samples in the window (Q15)
+ */
+extern q15_t
+DspRms(struct dsp_rms *rms, q15_t x);
+
+/**
+ * Compute the minimum, maximum and mean of a window of samples.
+ * @param[in] in Samples
+ * @param[in] log2 Log2 of the number of samples
+ * @param[out] stats Statistics
+ */
+extern void
+DspStats(q15_t const *in, uint8_t log2, struct dsp_stats *stats);
+
+/**
+ * Compute the FFT of a buffer in place.
+ *
+ * Each stage is scaled by 1/2 to avoid overflows, the result is the DFT divided by the
+ * number of points.
+ * @param[in,out] data Samples in the time domain (magnitude below 1.0), then in the
+ * frequency domain
+ * @param[in] log2 Log2 of the number of points, up to DSP_FFT_LOG2_MAX
+ */
+extern void
+DspFft(struct dsp_complex *data, uint8_t log2);
+
+/**
+ * Compute the integer square root.
+ * @param[in] x Value
+ * @return The square root of the value, rounded down
+ */
+extern uint16_t
+DspSqrt(uint32_t x);
+
+#endif // _DSP_H_
@@ -0,0 +1,227 @@
+/*
+ * Internal Flash read cache implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "FlashCache.h"
+
+/// Tag of a line that does not hold any data
+#define FLASH_CACHE_INVALID (0xFFFFFFFF)
+
+/// Cache environment
+static struct flash_cache
+{
+    /// NVM type
+    nvmType_t type;
+
+    /// Access counter, used to find the least recently used line
+    uint32_t clock;
+
+    /// Line number of the last line accessed, for the sequential access detection
+    uint32_t last;
+
+    /// Line number held by each line
+    uint32_t tag[FLASH_CACHE_LINES];
+
+    /// Value of the access counter when each line was last used
+    uint32_t used[FLASH_CACHE_LINES];
+
+    /// Line data (word aligned to allow word copies by NVM_Read)
+    uint32_t data[FLASH_CACHE_LINES][FLASH_CACHE_LINE_SIZE / 4];
+
+    /// Statistics
+    struct flash_cache_stats stats;
+} flash_cache;
+
+/**
+ * Find the least recently used line, excluding a line.
+ * @param[in] skip Index of the line to keep
+ * @return Index of the line to replace
+ */
+static int
+FlashCacheVictim(int skip)
+{
+    int i, victim = -1;
+
+    for (i = 0; i < FLASH_CACHE_LINES; i++)
+    {
+        if (i == skip)
+        {
+            continue;
+        }
+        if ((victim < 0) || ((int32_t)(flash_cache.used[i] - flash_cache.used[victim]) < 0))
+        {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+/**
+ * Get the cache line holding a flash line, fetch it on a miss.
+ * @param[in] line Flash line number
+ * @param[out] err NVM_Read status
+ * @return Index of the cache line, -1 if the fetch failed
+ */
+static int
+FlashCacheLine(uint32_t line, nvmErr_t *err)
+{
+    uint32_t buf[2][FLASH_CACHE_LINE_SIZE / 4];
+    int i, j, k;
+
+    flash_cache.clock++;
+
+    for (i = 0; i < FLASH_CACHE_LINES; i++)
+    {
+        if (flash_cache.tag[i] == line)
+        {
+            flash_cache.stats.hits++;
+            flash_cache.used[i] = flash_cache.clock;
+            flash_cache.last = line;
+            return i;
+        }
+    }
+
+    flash_cache.stats.misses++;
+    i = FlashCacheVictim(-1);
+
+    // check if the access pattern is sequential and the next line is readable
+    if ((flash_cache.last != FLASH_CACHE_INVALID) && (line == (flash_cache.last + 1)) &&
+        (((line + 2) * FLASH_CACHE_LINE_SIZE) <= FLASH_CACHE_READ_END))
+    {
+        // fetch both lines in a single call to amortize the NVM call overhead
+        *err = NVM_Read(gNvmInternalInterface_c, flash_cache.type, buf,
+                line * FLASH_CACHE_LINE_SIZE, 2 * FLASH_CACHE_LINE_SIZE);
+        if (*err)
+        {
+            return -1;
+        }
+
+        // the next line may already be in the cache
+        for (j = 0; j < FLASH_CACHE_LINES; j++)
+        {
+            if (flash_cache.tag[j] == (line + 1))
+            {
+                break;
+            }
+        }
+        if (j == FLASH_CACHE_LINES)
+        {
+            // the prefetched line keeps the date of the line it replaces, the oldest one,
+            // so that it is replaced first if unused (a hit makes it the most recent)
+            j = FlashCacheVictim(i);
+            flash_cache.tag[j] = line + 1;
+            for (k = 0; k < (FLASH_CACHE_LINE_SIZE / 4); k++)
+            {
+                flash_cache.data[j][k] = buf[1][k];
+            }
+            flash_cache.stats.prefetches++;
+        }
+        for (k = 0; k < (FLASH_CACHE_LINE_SIZE / 4); k++)
+        {
+            flash_cache.data[i][k] = buf[0][k];
+        }
+    }
+    else
+    {
+        *err = NVM_Read(gNvmInternalInterface_c, flash_cache.type, flash_cache.data[i],
+                line * FLASH_CACHE_LINE_SIZE, FLASH_CACHE_LINE_SIZE);
+        if (*err)
+        {
+            flash_cache.tag[i] = FLASH_CACHE_INVALID;
+            return -1;
+        }
+    }
+
+    flash_cache.tag[i] = line;
+    flash_cache.used[i] = flash_cache.clock;
+    flash_cache.last = line;
+    return i;
+}
+
+void
+FlashCacheInit(nvmType_t type)
+{
+    flash_cache.type = type;
+    flash_cache.clock = 0;
+    flash_cache.stats.hits = 0;
+    flash_cache.stats.misses = 0;
+    flash_cache.stats.prefetches = 0;
+    FlashCacheInvalidate();
+}
+
+nvmErr_t
+FlashCacheRead(void *dest, uint32_t addr, uint32_t len)
+{
+    uint8_t *d = dest;
+    nvmErr_t err = gNvmErrNoError_c;
+
+    // the whole range must be readable, the lines never reach the last sector
+    if ((addr >= FLASH_CACHE_READ_END) || (len > (FLASH_CACHE_READ_END - addr)))
+    {
+        return gNvmErrRestrictedArea_c;
+    }
+
+    while (len)
+    {
+        uint32_t offset = addr & (FLASH_CACHE_LINE_SIZE - 1);
+        uint32_t chunk = FLASH_CACHE_LINE_SIZE - offset;
+        uint8_t const *s;
+        int i;
+
+        i = FlashCacheLine(addr / FLASH_CACHE_LINE_SIZE, &err);
+        if (i < 0)
+        {
+            break;
+        }
+
+        if (chunk > len)
+        {
+            chunk = len;
+        }
+        s = ((uint8_t const *)flash_cache.data[i]) + offset;
+
+        addr += chunk;
+        len -= chunk;
+        while (chunk--)
+        {
+            *d++ = *s++;
+        }
+    }
+
+    return err;
+}
+
+void
+FlashCacheInvalidate(void)
+{
+    int i;
+
+    for (i = 0; i < FLASH_CACHE_LINES; i++)
+    {
+        flash_cache.tag[i] = FLASH_CACHE_INVALID;
+        flash_cache.used[i] = 0;
+    }
+    flash_cache.last = FLASH_CACHE_INVALID;
+}
+
+struct flash_cache_stats const *
+FlashCacheStats(void)
+{
+    return &flash_cache.stats;
+}
@@ -0,0 +1,88 @@
+/*
+ * Internal Flash read cache API
+ *
+ * The reads are served from a few RAM lines filled with NVM_Read.  The least recently
+ * used line is replaced on a miss, and a miss following an access to the previous
+ * line also fetches the next line in the same NVM_Read.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FLASHCACHE_H_
+#define _FLASHCACHE_H_
+
+// standard includes
+#include <stdint.h>
+
+// for the NVM types
+#include "NVM.h"
+
+/// Size of a cache line (power of 2)
+#define FLASH_CACHE_LINE_SIZE (64)
+
+/// Number of cache lines
+#define FLASH_CACHE_LINES     (8)
+
+/// End of the readable area of the internal flash, NVM_Read rejects the last sector
+/// (gNvmErrRestrictedArea_c)
+#define FLASH_CACHE_READ_END  (0x1F000)
+
+/// Cache statistics
+struct flash_cache_stats
+{
+    /// Number of line accesses found in the cache
+    uint32_t hits;
+
+    /// Number of line accesses that required an NVM_Read
+    uint32_t misses;
+
+    /// Number of lines fetched ahead of their use
+    uint32_t prefetches;
+};
+
+/**
+ * Initialize the cache, all the lines are invalid and the statistics are cleared.
+ * @param[in] type NVM type as returned by NVM_Detect
+ * @warning The flash regulators must have been started (@ref FlashStartReg)
+ */
+extern void
+FlashCacheInit(nvmType_t type);
+
+/**
+ * Read from the internal flash through the cache.
+ * @param[out] dest Buffer receiving the data
+ * @param[in] addr Address in the internal flash
+ * @param[in] len Number of bytes to read
+ * @return gNvmErrNoError_c, gNvmErrRestrictedArea_c if the range goes beyond
+ * @ref FLASH_CACHE_READ_END (nothing is read) or the error returned by NVM_Read
+ */
+extern nvmErr_t
+FlashCacheRead(void *dest, uint32_t addr, uint32_t len);
+
+/**
+ * Invalidate all the lines, to be called after the internal flash was written or erased.
+ */
+extern void
+FlashCacheInvalidate(void);
+
+/**
+ * Get the cache statistics.
+ * @return Pointer to the statistics, updated at each access
+ */
+extern struct flash_cache_stats const *
+FlashCacheStats(void);
+
+#endif // _FLASHCACHE_H_
@@ -0,0 +1,210 @@
+/*
+ * Interrupt handlers profiler implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "IsrProf.h"
+
+// for the hooks
+#include "Itc.h"
+
+// for the timestamps
+#include "Clock.h"
+
+// for the dump
+#include "Uart1.h"
+
+// for the critical sections
+#include "proc/proc.h"
+
+// for the pending sources
+#include "reg_itc.h"
+
+/// Profiler environment
+static struct isr_prof_env
+{
+    /// Statistics of the sources
+    struct isr_prof_stats stats[ITC_VECTORS];
+
+    /// Date at which the pending sources were seen first
+    uint32_t first[ITC_VECTORS];
+
+    /// Sources seen pending and not handled yet
+    uint16_t seen;
+
+    /// Number of handlers running (nested)
+    uint8_t depth;
+
+    /// Entry date of the handlers running
+    uint32_t entry[ITC_VECTORS];
+
+    /// Time spent in the handlers preempting the handlers running
+    uint32_t preempt[ITC_VECTORS];
+} isr_prof_env;
+
+/**
+ * Note the date at which the sources become pending.
+ * @param[in] now Current date
+ */
+static void
+IsrProfPending(uint32_t now)
+{
+    uint16_t pending = itc_nipend_getf() | itc_fipend_getf();
+    uint16_t fresh = pending & ~isr_prof_env.seen;
+    uint8_t src;
+
+    for (src = 0; fresh; src++, fresh >>= 1)
+    {
+        if (fresh & 1)
+        {
+            isr_prof_env.first[src] = now;
+        }
+    }
+
+    // forget the sources that went away without being handled
+    isr_prof_env.seen = pending;
+}
+
+/**
+ * Hook upon handler entry.
+ * @param[in] src Source
+ */
+static void
+IsrProfEnter(uint8_t src)
+{
+    struct isr_prof_stats *stats = &isr_prof_env.stats[src];
+    uint32_t now, latency;
+
+    PROC_INT_DISABLE();
+    now = ClockGet32();
+    IsrProfPending(now);
+
+    latency = now - isr_prof_env.first[src];
+    if ((isr_prof_env.seen & (1 << src)) && (latency > stats->max_latency))
+    {
+        stats->max_latency = latency;
+    }
+    isr_prof_env.seen &= ~(1 << src);
+
+    isr_prof_env.entry[isr_prof_env.depth] = now;
+    isr_prof_env.preempt[isr_prof_env.depth] = 0;
+    isr_prof_env.depth++;
+    PROC_INT_RESTORE();
+}
+
+/**
+ * Hook upon handler exit.
+ * @param[in] src Source
+ */
+static void
+IsrProfExit(uint8_t src)
+{
+    struct isr_prof_stats *stats = &isr_prof_env.stats[src];
+    uint32_t now, elapsed, duration;
+
+    PROC_INT_DISABLE();
+    now = ClockGet32();
+    isr_prof_env.depth--;
+
+    // the time spent in the nested handlers is accounted to them
+    elapsed = now - isr_prof_env.entry[isr_prof_env.depth];
+    duration = elapsed - isr_prof_env.preempt[isr_prof_env.depth];
+    if (isr_prof_env.depth)
+    {
+        isr_prof_env.preempt[isr_prof_env.depth - 1] += elapsed;
+    }
+
+    stats->count++;
+    stats->total += duration;
+    if (duration > stats->max_duration)
+    {
+        stats->max_duration = duration;
+    }
+
+    IsrProfPending(now);
+    PROC_INT_RESTORE();
+}
+
+void
+IsrProfStart(void)
+{
+    IsrProfReset();
+    isr_prof_env.seen = 0;
+    isr_prof_env.depth = 0;
+    ItcHooks(IsrProfEnter, IsrProfExit);
+}
+
+void
+IsrProfStop(void)
+{
+    ItcHooks(NULL, NULL);
+}
+
+void
+IsrProfReset(void)
+{
+    struct isr_prof_stats *stats;
+    uint8_t src;
+
+    PROC_INT_DISABLE();
+    for (src = 0; src < ITC_VECTORS; src++)
+    {
+        stats = &isr_prof_env.stats[src];
+        stats->count = 0;
+        stats->total = 0;
+        stats->max_duration = 0;
+        stats->max_latency = 0;
+    }
+    PROC_INT_RESTORE();
+}
+
+void
+IsrProfGet(uint8_t src, struct isr_prof_stats *stats)
+{
+    PROC_INT_DISABLE();
+    *stats = isr_prof_env.stats[src];
+    PROC_INT_RESTORE();
+}
+
+void
+IsrProfDump(void)
+{
+    struct isr_prof_stats stats;
+    uint8_t src;
+
+    Uart1PutS("\nISR: count, total (us), max duration (us), max latency (us)");
+    for (src = 0; src < ITC_VECTORS; src++)
+    {
+        IsrProfGet(src, &stats);
+        if (!stats.count)
+        {
+            continue;
+        }
+
+        Uart1PutS("\n0x");
+        Uart1PutU8(src);
+        Uart1PutS(": 0x");
+        Uart1PutU32(stats.count);
+        Uart1PutS(", 0x");
+        Uart1PutU32(ClockTicksToUs(stats.total));
+        Uart1PutS(", 0x");
+        Uart1PutU32(ClockTicksToUs(stats.max_duration));
+        Uart1PutS(", 0x");
+        Uart1PutU32(ClockTicksToUs(stats.max_latency));
+    }
+}
@@ -0,0 +1,84 @@
+/*
+ * Interrupt handlers profiler API
+ *
+ * The profiler is hooked around the handlers called by the interrupt controller and
+ * timestamps them with the clock (TMR2 and TMR3 at 24MHz).  For each source, it counts
+ * the handler calls and measures their duration, excluding the time spent in the
+ * handlers preempting them.
+ *
+ * The entry latency is measured from the first hook that sees the source pending in
+ * the ITC: it is the time the source waited for the other handlers, the latency due
+ * to the exception entry or to the critical sections is not visible.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ISRPROF_H_
+#define _ISRPROF_H_
+
+// standard includes
+#include <stdint.h>
+
+/// Statistics of a source, in clock ticks
+struct isr_prof_stats
+{
+    /// Number of handler calls
+    uint32_t count;
+
+    /// Cumulated duration of the handler
+    uint32_t total;
+
+    /// Maximum duration of the handler
+    uint32_t max_duration;
+
+    /// Maximum entry latency
+    uint32_t max_latency;
+};
+
+/**
+ * Reset the statistics and start profiling the handlers.
+ * @warning The clock must be initialized (see ClockInit).
+ */
+extern void
+IsrProfStart(void);
+
+/**
+ * Stop profiling the handlers, the statistics are kept.
+ */
+extern void
+IsrProfStop(void);
+
+/**
+ * Reset the statistics of all the sources.
+ */
+extern void
+IsrProfReset(void);
+
+/**
+ * Get the statistics of a source.
+ * @param[in] src Source
+ * @param[out] stats Statistics
+ */
+extern void
+IsrProfGet(uint8_t src, struct isr_prof_stats *stats);
+
+/**
+ * Print the statistics of the sources that were handled, in microseconds.
+ */
+extern void
+IsrProfDump(void);
+
+#endif // _ISRPROF_H_
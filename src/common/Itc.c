@@ -0,0 +1,126 @@
+/*
+ * Interrupt controller implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "Itc.h"
+
+// for the exception handler attributes
+#include "compiler.h"
+
+// for the ITC registers
+#include "reg_itc.h"
+
+/// Normal interrupt mask level disabling the masking
+#define ITC_NIMASK_NONE (0x1F)
+
+/// Interrupt controller environment
+static struct itc_env
+{
+    /// Handlers of the sources, indexed by the vector read from the ITC
+    itc_handler_t handlers[ITC_VECTORS];
+
+    /// Hooks around the handlers
+    itc_hook_t enter;
+    itc_hook_t exit;
+} itc_env;
+
+/**
+ * Call the handler of a source.
+ * @param[in] src Source read from the vector register
+ */
+__INLINE void ItcDispatch(uint8_t src)
+{
+    itc_handler_t handler = itc_env.handlers[src];
+
+    if (!handler)
+    {
+        // no one to clear the source, it would fire again
+        itc_disnum_setf(src);
+        return;
+    }
+
+    if (itc_env.enter)
+    {
+        itc_env.enter(src);
+    }
+    handler();
+    if (itc_env.exit)
+    {
+        itc_env.exit(src);
+    }
+}
+
+__FIQ __RAMFUNC void FiqHandler(void)
+{
+    ItcDispatch(itc_fivector_getf());
+}
+
+__RAMFUNC void
+ItcIrq(uint8_t src)
+{
+    ItcDispatch(src);
+}
+
+void
+ItcInit(void)
+{
+    uint8_t src;
+
+    itc_intenable_setf(0);
+    itc_inttype_setf(0);
+    itc_nimask_setf(ITC_NIMASK_NONE);
+
+    for (src = 0; src < ITC_VECTORS; src++)
+    {
+        itc_env.handlers[src] = NULL;
+    }
+    itc_env.enter = NULL;
+    itc_env.exit = NULL;
+}
+
+void
+ItcSet(uint8_t src, itc_handler_t handler, uint8_t type)
+{
+    // route the source while it is disabled
+    itc_disnum_setf(src);
+    itc_env.handlers[src] = handler;
+    if (type == ITC_FIQ)
+    {
+        itc_inttype_setf(itc_inttype_getf() | (1 << src));
+    }
+    else
+    {
+        itc_inttype_setf(itc_inttype_getf() & ~(1 << src));
+    }
+    itc_ennum_setf(src);
+}
+
+void
+ItcClear(uint8_t src)
+{
+    itc_disnum_setf(src);
+    itc_env.handlers[src] = NULL;
+}
+
+void
+ItcHooks(itc_hook_t enter, itc_hook_t exit)
+{
+    itc_env.enter = enter;
+    itc_env.exit = exit;
+}
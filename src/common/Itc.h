@@ -0,0 +1,106 @@
+/*
+ * Interrupt controller API
+ *
+ * The FiqHandler and IrqHandler exception handlers read the vector of the pending
+ * source from the ITC and call the handler registered for it in a RAM table.  Each
+ * source is routed either to the FIQ or to the IRQ; among the sources of the same
+ * type, the ITC gives the priority to the highest number.
+ *
+ * The IRQ handlers are nested: while a handler runs, the IRQ sources of a higher number
+ * can preempt it (see Itc_asm.s).  The FIQ sources preempt all the IRQ handlers, they
+ * should be kept for the sources needing a deterministic latency.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ITC_H_
+#define _ITC_H_
+
+// standard includes
+#include <stdint.h>
+#include <stddef.h>
+
+/// Interrupt sources, lowest priority first
+enum itc_src
+{
+    ITC_SRC_ASM = 0,
+    ITC_SRC_UART1,
+    ITC_SRC_UART2,
+    ITC_SRC_CRM,
+    ITC_SRC_I2C,
+    ITC_SRC_TMR,
+    ITC_SRC_SPIF,
+    ITC_SRC_MACA,
+    ITC_SRC_SSI,
+    ITC_SRC_ADC,
+    ITC_SRC_SPI,
+    ITC_SOURCES
+};
+
+/// Size of the handlers table (the vectors are 4 bits wide)
+#define ITC_VECTORS (16)
+
+/// Routing of a source to the core
+enum itc_type
+{
+    ITC_IRQ = 0,
+    ITC_FIQ
+};
+
+/// Handler of an interrupt source
+typedef void (*itc_handler_t)(void);
+
+/// Hook upon entry or exit of a handler
+typedef void (*itc_hook_t)(uint8_t src);
+
+/**
+ * Initialize the interrupt controller: all the sources are disabled and have no handler.
+ */
+extern void
+ItcInit(void);
+
+/**
+ * Register the handler of a source and enable it.
+ * @param[in] src Source
+ * @param[in] handler Handler, called from the exception handler
+ * @param[in] type ITC_FIQ or ITC_IRQ
+ */
+extern void
+ItcSet(uint8_t src, itc_handler_t handler, uint8_t type);
+
+/**
+ * Disable a source and remove its handler.
+ * @param[in] src Source
+ */
+extern void
+ItcClear(uint8_t src);
+
+/**
+ * Call the handler of an IRQ source, from the nested IRQ handler.
+ * @param[in] src Source
+ */
+extern void
+ItcIrq(uint8_t src);
+
+/**
+ * Set the hooks called around every handler, e.g. to profile them.
+ * @param[in] enter Hook called before the handler, NULL for none
+ * @param[in] exit Hook called after the handler, NULL for none
+ */
+extern void
+ItcHooks(itc_hook_t enter, itc_hook_t exit);
+
+#endif // _ITC_H_
@@ -0,0 +1,78 @@
+#/*
+# * Nested IRQ handler.
+# *
+# * The IRQ mode only saves the interrupted context and masks the normal interrupts up
+# * to the level of the source (NIMASK), then the handler runs in SYS mode with the
+# * IRQ enabled, so that the sources of higher level preempt it.  The FIQ is never
+# * masked by this path.
+# *
+# *    Copyright (C) 2009 Louis Caron
+# *
+# *    This program is free software: you can redistribute it and/or modify
+# *    it under the terms of the GNU General Public License as published by
+# *    the Free Software Foundation, either version 3 of the License, or
+# *    (at your option) any later version.
+# *
+# *    This program is distributed in the hope that it will be useful,
+# *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+# *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# *    GNU General Public License for more details.
+# *
+# *    You should have received a copy of the GNU General Public License
+# *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+# */
+
+# on the hot path (see __RAMFUNC)
+.section .ramfunc, "ax"
+    .align 4
+
+.set ITC_MODE_IRQ, 0x12
+.set ITC_MODE_SYS, 0x1F
+.set ITC_IRQ_MASK, 0x80
+
+# ITC registers, NIVECTOR is accessed relative to NIMASK
+.set ITC_NIMASK_ADDR, 0x80020004
+.set ITC_NIVECTOR_OFFSET, 0x24
+# only the low bits of NIVECTOR are the source, the mask keeps the handlers table index
+# and the NIMASK level in range
+.set ITC_NIVECTOR_MASK, 0xF
+
+#/**
+# * IRQ exception handler
+# */
+.global IrqHandler
+.type   IrqHandler, function
+IrqHandler:
+    # IRQ stack, 5 words per nesting level:
+    #   - return address and work registers
+    #   - SPSR
+    #   - previous NIMASK
+    SUB     lr, lr, #4
+    stmdb   sp!, {r0, r1, lr}
+    MRS     r0, SPSR
+    stmdb   sp!, {r0}
+
+    # mask the sources up to the current one, the ITC priority is the source number
+    LDR     r1, =ITC_NIMASK_ADDR
+    LDR     r0, [r1]
+    stmdb   sp!, {r0}
+    LDR     r0, [r1, #ITC_NIVECTOR_OFFSET]
+    AND     r0, r0, #ITC_NIVECTOR_MASK
+    STR     r0, [r1]
+
+    # run the handler in SYS mode with the IRQ enabled, r0 is the source
+    MSR     CPSR_c, #ITC_MODE_SYS
+    stmdb   sp!, {r2, r3, r12, lr}
+    BL      ItcIrq
+    ldmia   sp!, {r2, r3, r12, lr}
+    MSR     CPSR_c, #ITC_MODE_IRQ | ITC_IRQ_MASK
+
+    # restore the previous mask level
+    ldmia   sp!, {r0}
+    LDR     r1, =ITC_NIMASK_ADDR
+    STR     r0, [r1]
+
+    # return to the interrupted context
+    ldmia   sp!, {r0}
+    MSR     SPSR_cxsf, r0
+    ldmia   sp!, {r0, r1, pc}^
@@ -0,0 +1,246 @@
+/*
+ * Keypad implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "Keypad.h"
+
+// for the sampling period
+#include "Time.h"
+
+// for the wake-up pads and timer
+#include "reg_crm.h"
+
+// for the pads level
+#include "reg_gpio.h"
+
+/// Mask of the buttons
+#define KEYPAD_MASK ((1 << KEYPAD_KEYS) - 1)
+
+/// Keypad environment
+static struct keypad_env
+{
+    /// Callback when the queue becomes non empty
+    void (*notify)(void);
+
+    /// Sampling period (RTC ticks)
+    uint32_t period;
+
+    /// Number of events lost
+    uint32_t overruns;
+
+    /// Debounced state of the buttons
+    uint8_t pressed;
+
+    /// Sampling in progress
+    bool sampling;
+
+    /// Number of consecutive samples different from the debounced state
+    uint8_t bounce[KEYPAD_KEYS];
+
+    /// Number of samples since the press, up to KEYPAD_LONG
+    uint8_t held[KEYPAD_KEYS];
+
+    /// Number of samples before the next repeat
+    uint8_t repeat[KEYPAD_KEYS];
+
+    /// Events queued, written by the interrupt and read by the application
+    struct keypad_event queue[KEYPAD_QUEUE];
+    volatile uint8_t head;
+    volatile uint8_t tail;
+} keypad_env;
+
+/**
+ * Queue an event, the application is notified if the queue was empty.
+ * @param[in] key Button
+ * @param[in] type Event type
+ */
+static void
+KeypadPush(uint8_t key, uint8_t type)
+{
+    uint8_t head = keypad_env.head;
+    struct keypad_event *event;
+
+    if ((uint8_t) (head - keypad_env.tail) == KEYPAD_QUEUE)
+    {
+        keypad_env.overruns++;
+        return;
+    }
+
+    event = &keypad_env.queue[head & (KEYPAD_QUEUE - 1)];
+    event->key = key;
+    event->type = type;
+    keypad_env.head = head + 1;
+
+    if ((head == keypad_env.tail) && keypad_env.notify)
+    {
+        keypad_env.notify();
+    }
+}
+
+/**
+ * Sample the pads and update the state of the buttons.
+ * @return true while a button is pressed or bouncing
+ */
+static bool
+KeypadSample(void)
+{
+    uint8_t raw, key, bit;
+
+    // the buttons pull the pads low
+    raw = (~gpio_data0_get() >> KEYPAD_GPIO) & KEYPAD_MASK;
+
+    for (key = 0, bit = 1; key < KEYPAD_KEYS; key++, bit <<= 1)
+    {
+        if ((raw ^ keypad_env.pressed) & bit)
+        {
+            // the new level must be stable during the debounce time
+            if (++keypad_env.bounce[key] < KEYPAD_DEBOUNCE)
+            {
+                continue;
+            }
+            keypad_env.bounce[key] = 0;
+            keypad_env.held[key] = 0;
+            keypad_env.pressed ^= bit;
+            KeypadPush(key, (keypad_env.pressed & bit) ? KEYPAD_PRESS : KEYPAD_RELEASE);
+        }
+        else
+        {
+            keypad_env.bounce[key] = 0;
+            if (!(keypad_env.pressed & bit))
+            {
+                continue;
+            }
+
+            // long press, then repeats while held
+            if (keypad_env.held[key] < KEYPAD_LONG)
+            {
+                if (++keypad_env.held[key] == KEYPAD_LONG)
+                {
+                    keypad_env.repeat[key] = KEYPAD_REPEAT;
+                    KeypadPush(key, KEYPAD_LONG_PRESS);
+                }
+            }
+            else if (!--keypad_env.repeat[key])
+            {
+                keypad_env.repeat[key] = KEYPAD_REPEAT;
+                KeypadPush(key, KEYPAD_REPEAT_PRESS);
+            }
+        }
+    }
+
+    return (raw | keypad_env.pressed) != 0;
+}
+
+void
+KeypadInit(void (*notify)(void))
+{
+    uint8_t key;
+
+    keypad_env.notify = notify;
+    keypad_env.period = TimeMsToTicks(KEYPAD_SAMPLE_MS);
+    if (!keypad_env.period)
+    {
+        keypad_env.period = 1;
+    }
+    keypad_env.overruns = 0;
+    keypad_env.pressed = 0;
+    keypad_env.sampling = false;
+    keypad_env.head = 0;
+    keypad_env.tail = 0;
+    for (key = 0; key < KEYPAD_KEYS; key++)
+    {
+        keypad_env.bounce[key] = 0;
+        keypad_env.held[key] = 0;
+    }
+
+    // wait for a press on the pads
+    crm_rtc_wu_ien_setf(0);
+    crm_rtc_wu_en_setf(0);
+    crm_status_set(EXT_WU_EVT_MASK | RTC_WU_EVT_BIT);
+    crm_ext_wu_ien_setf(KEYPAD_MASK);
+}
+
+bool
+KeypadGet(struct keypad_event *event)
+{
+    uint8_t tail = keypad_env.tail;
+
+    if (tail == keypad_env.head)
+    {
+        return false;
+    }
+
+    *event = keypad_env.queue[tail & (KEYPAD_QUEUE - 1)];
+    keypad_env.tail = tail + 1;
+
+    return true;
+}
+
+uint8_t
+KeypadState(void)
+{
+    return keypad_env.pressed;
+}
+
+uint32_t
+KeypadOverruns(void)
+{
+    return keypad_env.overruns;
+}
+
+void
+KeypadInt(void)
+{
+    uint32_t status = crm_status_get();
+
+    if (status & EXT_WU_EVT_MASK)
+    {
+        // the pads are sampled from now on, their interrupts would only signal bounces
+        crm_ext_wu_ien_setf(0);
+        crm_status_set(EXT_WU_EVT_MASK);
+
+        if (!keypad_env.sampling)
+        {
+            keypad_env.sampling = true;
+            KeypadSample();
+            crm_rtc_timeout_set(keypad_env.period);
+            crm_rtc_wu_en_setf(1);
+            crm_rtc_wu_ien_setf(1);
+        }
+    }
+
+    if ((status & RTC_WU_EVT_BIT) && keypad_env.sampling)
+    {
+        crm_status_set(RTC_WU_EVT_BIT);
+
+        if (KeypadSample())
+        {
+            crm_rtc_timeout_set(keypad_env.period);
+        }
+        else
+        {
+            // all the buttons are released, wait for the next press
+            keypad_env.sampling = false;
+            crm_rtc_wu_ien_setf(0);
+            crm_rtc_wu_en_setf(0);
+            crm_status_set(EXT_WU_EVT_MASK);
+            crm_ext_wu_ien_setf(KEYPAD_MASK);
+        }
+    }
+}
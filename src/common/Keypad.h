@@ -0,0 +1,118 @@
+/*
+ * Keypad API
+ *
+ * The push buttons are connected to the KBI[7..4] pads, the wake-up pads 0 to 3, and
+ * pull the pads low when pressed.  A press is signaled by the pad interrupt, then the
+ * pads are sampled on the RTC wake-up timer until all the buttons are released: a
+ * button changes state after the same level has been sampled for the debounce time.
+ * The events of all the buttons are queued, the application is notified once when the
+ * queue becomes non empty and reads all the events from its own context.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _KEYPAD_H_
+#define _KEYPAD_H_
+
+// standard includes
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/// Number of buttons
+#define KEYPAD_KEYS (4)
+
+/// GPIO of the first button (KBI4)
+#define KEYPAD_GPIO (26)
+
+/// Sampling period of the pads while a button is pressed (milliseconds)
+#define KEYPAD_SAMPLE_MS (5)
+
+/// Number of identical samples for a button to change state (20ms)
+#define KEYPAD_DEBOUNCE (4)
+
+/// Number of samples before a long press (800ms)
+#define KEYPAD_LONG (160)
+
+/// Number of samples between two repeats after a long press (200ms)
+#define KEYPAD_REPEAT (40)
+
+/// Number of events queued (power of 2)
+#define KEYPAD_QUEUE (8)
+
+/// Events of a button
+enum keypad_type
+{
+    /// Button pressed
+    KEYPAD_PRESS = 0,
+    /// Button released
+    KEYPAD_RELEASE,
+    /// Button held for KEYPAD_LONG samples
+    KEYPAD_LONG_PRESS,
+    /// Button still held, every KEYPAD_REPEAT samples after the long press
+    KEYPAD_REPEAT_PRESS
+};
+
+/// Event of a button
+struct keypad_event
+{
+    /// Button, from 0 to KEYPAD_KEYS - 1
+    uint8_t key;
+
+    /// Event type (enum keypad_type)
+    uint8_t type;
+};
+
+/**
+ * Initialize the keypad: the pads interrupts are enabled on the falling edge.
+ * @param[in] notify Callback when an event is queued while the queue was empty, called
+ * from @ref KeypadInt (can be NULL if the application polls the queue)
+ * @warning The RTC wake-up timer is used by the keypad, the time conversions must be
+ * calibrated (e.g. with RoscCalApply) for the debounce times to be accurate.
+ */
+extern void
+KeypadInit(void (*notify)(void));
+
+/**
+ * Get the oldest event queued.
+ * @param[out] event Event
+ * @return true if an event was queued, false if the queue is empty
+ */
+extern bool
+KeypadGet(struct keypad_event *event);
+
+/**
+ * Get the debounced state of the buttons.
+ * @return Bitfield of the buttons pressed (bit n for button n)
+ */
+extern uint8_t
+KeypadState(void);
+
+/**
+ * Get the number of events lost because the queue was full.
+ * @return The number of events lost since @ref KeypadInit
+ */
+extern uint32_t
+KeypadOverruns(void);
+
+/**
+ * Function to call upon CRM interrupt.  The pads and RTC wake-up events are handled
+ * and cleared, the other CRM events are left to the application.
+ */
+extern void
+KeypadInt(void);
+
+#endif // _KEYPAD_H_
@@ -0,0 +1,499 @@
+/*
+ * Persistent key/value store implementation
+ *
+ * Each sector of the store starts with a header holding a sequence number, the valid
+ * sector with the highest sequence number is the active one.  The records follow the
+ * header:
+ *
+ *   | key (8) | len (8) | crc (16) | value (len bytes, padded to a word) |
+ *
+ * The CRC covers the key, the length and the value, it is used to detect a record that
+ * was only partially written when the power failed.  A length of 0 removes the key.
+ *
+ * When the active sector is full, the live records are copied into the next sector
+ * and the header of this sector is written last: until then, the old sector remains
+ * the active one.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "KvStore.h"
+
+/// Magic value identifying an initialized sector ("KVS1")
+#define KV_MAGIC        (0x3153564B)
+
+/// Key value of an erased record
+#define KV_KEY_FREE     (0xFF)
+
+/// Sector header
+struct kv_sector
+{
+    /// Magic value, written last
+    uint32_t magic;
+
+    /// Sequence number of the sector (incremented at each sector change)
+    uint32_t seq;
+};
+
+/// Record header (size must be word multiple)
+struct kv_rec
+{
+    /// Key of the record
+    uint8_t key;
+
+    /// Length of the value following the header
+    uint8_t len;
+
+    /// CRC of the key, length and value
+    uint16_t crc;
+};
+
+/// Store environment
+static struct kv_env
+{
+    /// NVM type
+    nvmType_t type;
+
+    /// Index of the active sector
+    uint8_t active;
+
+    /// Sequence number of the active sector
+    uint32_t seq;
+
+    /// Offset of the first free byte in the active sector
+    uint32_t wr;
+
+    /// Offset of the last record of each key in the active sector (0 if none)
+    uint16_t index[KV_KEY_NUM];
+
+    /// Record buffer
+    union
+    {
+        struct kv_rec rec;
+        uint8_t bytes[sizeof(struct kv_rec) + KV_VALUE_MAX];
+    } buf;
+} kv_env;
+
+/// Size of a record in flash
+#define KV_REC_SIZE(__len) (sizeof(struct kv_rec) + (((__len) + 3) & ~3))
+
+/// Address in flash of an offset in one of the sectors of the store
+#define KV_ADDR(__s, __o) (((KV_SECTOR_FIRST + (__s)) * KV_SECTOR_SIZE) + (__o))
+
+/**
+ * Compute the CRC16 (CCITT) of a buffer.
+ * @param[in] crc Initial CRC value
+ * @param[in] p Buffer
+ * @param[in] len Length of the buffer
+ * @return The updated CRC
+ */
+static uint16_t
+KvCrc(uint16_t crc, uint8_t const *p, uint32_t len)
+{
+    int i;
+
+    while (len--)
+    {
+        crc ^= (*p++) << 8;
+        for (i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * Compute the CRC of the record in the buffer.
+ * @return The CRC of the record
+ */
+static uint16_t
+KvRecCrc(void)
+{
+    uint16_t crc;
+
+    crc = KvCrc(0xFFFF, &kv_env.buf.rec.key, 2);
+    return KvCrc(crc, &kv_env.buf.bytes[sizeof(struct kv_rec)], kv_env.buf.rec.len);
+}
+
+static kvErr_t
+KvRead(uint8_t sector, uint32_t offset, void *dest, uint32_t len)
+{
+    if (NVM_Read(gNvmInternalInterface_c, kv_env.type, dest, KV_ADDR(sector, offset), len))
+    {
+        return KV_ERR_NVM;
+    }
+    return KV_OK;
+}
+
+static kvErr_t
+KvWrite(uint8_t sector, uint32_t offset, void *src, uint32_t len)
+{
+    if (NVM_Write(gNvmInternalInterface_c, kv_env.type, src, KV_ADDR(sector, offset), len))
+    {
+        return KV_ERR_NVM;
+    }
+    return KV_OK;
+}
+
+static kvErr_t
+KvErase(uint8_t sector)
+{
+    if (NVM_Erase(gNvmInternalInterface_c, kv_env.type, 1 << (KV_SECTOR_FIRST + sector)))
+    {
+        return KV_ERR_NVM;
+    }
+    return KV_OK;
+}
+
+/**
+ * Read a record from the active sector into the buffer and check it.
+ * @param[in] offset Offset of the record in the active sector
+ * @return KV_OK if the record is valid, KV_ERR_NOT_FOUND if the location is erased,
+ * KV_ERR_INVALID if the record is corrupted
+ */
+static kvErr_t
+KvRecRead(uint32_t offset)
+{
+    struct kv_rec *rec = &kv_env.buf.rec;
+
+    if (KvRead(kv_env.active, offset, rec, sizeof(*rec)))
+    {
+        return KV_ERR_NVM;
+    }
+
+    // check if this is the end of the log
+    if ((rec->key == KV_KEY_FREE) && (rec->len == 0xFF) && (rec->crc == 0xFFFF))
+    {
+        return KV_ERR_NOT_FOUND;
+    }
+
+    // check that the record fits and makes sense
+    if ((rec->key >= KV_KEY_NUM) || (rec->len > KV_VALUE_MAX) ||
+        ((offset + KV_REC_SIZE(rec->len)) > KV_SECTOR_SIZE))
+    {
+        return KV_ERR_INVALID;
+    }
+
+    if (KvRead(kv_env.active, offset + sizeof(*rec), rec + 1, rec->len))
+    {
+        return KV_ERR_NVM;
+    }
+
+    return (KvRecCrc() == rec->crc) ? KV_OK : KV_ERR_INVALID;
+}
+
+/**
+ * Rebuild the RAM index from the records of the active sector.
+ */
+static kvErr_t
+KvScan(void)
+{
+    kvErr_t err;
+    uint32_t offset = sizeof(struct kv_sector);
+    int i;
+
+    for (i = 0; i < KV_KEY_NUM; i++)
+    {
+        kv_env.index[i] = 0;
+    }
+
+    while (offset < KV_SECTOR_SIZE)
+    {
+        err = KvRecRead(offset);
+        if (err == KV_ERR_NVM)
+        {
+            return err;
+        }
+        if (err == KV_ERR_NOT_FOUND)
+        {
+            break;
+        }
+        if (err == KV_ERR_INVALID)
+        {
+            // interrupted write: the rest of the sector can not be trusted anymore, the
+            // next write will move the valid records to a fresh sector
+            offset = KV_SECTOR_SIZE;
+            break;
+        }
+
+        // the last record of a key is the valid one
+        kv_env.index[kv_env.buf.rec.key] = kv_env.buf.rec.len ? offset : 0;
+        offset += KV_REC_SIZE(kv_env.buf.rec.len);
+    }
+
+    kv_env.wr = offset;
+    return KV_OK;
+}
+
+/**
+ * Move the valid records into the next sector and make it the active one.
+ */
+static kvErr_t
+KvCompact(void)
+{
+    uint16_t index[KV_KEY_NUM];
+    uint8_t target;
+    uint32_t offset = sizeof(struct kv_sector);
+    struct kv_sector header;
+    int i;
+
+    // use the sectors in turn to share the erase cycles
+    target = kv_env.active + 1;
+    if (target == KV_SECTOR_NUM)
+    {
+        target = 0;
+    }
+
+    if (KvErase(target))
+    {
+        return KV_ERR_NVM;
+    }
+
+    // copy the valid records
+    for (i = 0; i < KV_KEY_NUM; i++)
+    {
+        index[i] = 0;
+        if (kv_env.index[i] == 0)
+        {
+            continue;
+        }
+        if (KvRecRead(kv_env.index[i]) != KV_OK)
+        {
+            return KV_ERR_NVM;
+        }
+        if (KvWrite(target, offset, &kv_env.buf, KV_REC_SIZE(kv_env.buf.rec.len)))
+        {
+            return KV_ERR_NVM;
+        }
+        index[i] = offset;
+        offset += KV_REC_SIZE(kv_env.buf.rec.len);
+    }
+
+    // commit the new sector
+    header.magic = KV_MAGIC;
+    header.seq = kv_env.seq + 1;
+    if (KvWrite(target, 0, &header, sizeof(header)))
+    {
+        return KV_ERR_NVM;
+    }
+
+    // the old sector is not needed anymore, a failure here is recovered by the sequence
+    KvErase(kv_env.active);
+
+    kv_env.active = target;
+    kv_env.seq = header.seq;
+    kv_env.wr = offset;
+    for (i = 0; i < KV_KEY_NUM; i++)
+    {
+        kv_env.index[i] = index[i];
+    }
+
+    return KV_OK;
+}
+
+/**
+ * Append the record in the buffer to the active sector.
+ */
+static kvErr_t
+KvAppend(void)
+{
+    struct kv_rec *rec = &kv_env.buf.rec;
+    uint32_t size = KV_REC_SIZE(rec->len);
+    uint8_t key = rec->key;
+    uint8_t len = rec->len;
+    kvErr_t err;
+    uint8_t i;
+
+    if ((kv_env.wr + size) > KV_SECTOR_SIZE)
+    {
+        // the compaction uses the buffer, so save the record in the remaining space
+        uint8_t value[KV_VALUE_MAX];
+
+        for (i = 0; i < len; i++)
+        {
+            value[i] = kv_env.buf.bytes[sizeof(*rec) + i];
+        }
+
+        err = KvCompact();
+        if (err)
+        {
+            return err;
+        }
+        if ((kv_env.wr + size) > KV_SECTOR_SIZE)
+        {
+            return KV_ERR_FULL;
+        }
+
+        rec->key = key;
+        rec->len = len;
+        for (i = 0; i < len; i++)
+        {
+            kv_env.buf.bytes[sizeof(*rec) + i] = value[i];
+        }
+    }
+
+    // the padding is left erased
+    rec->crc = KvRecCrc();
+    if (KvWrite(kv_env.active, kv_env.wr, &kv_env.buf, sizeof(*rec) + len))
+    {
+        // the location may be partially written: do not reuse it
+        kv_env.wr = KV_SECTOR_SIZE;
+        return KV_ERR_NVM;
+    }
+
+    kv_env.index[key] = len ? kv_env.wr : 0;
+    kv_env.wr += size;
+
+    return KV_OK;
+}
+
+kvErr_t
+KvInit(nvmType_t type)
+{
+    struct kv_sector header;
+    int found = 0;
+    uint8_t i;
+
+    kv_env.type = type;
+
+    // look for the most recent valid sector
+    for (i = 0; i < KV_SECTOR_NUM; i++)
+    {
+        if (KvRead(i, 0, &header, sizeof(header)))
+        {
+            return KV_ERR_NVM;
+        }
+        if (header.magic != KV_MAGIC)
+        {
+            continue;
+        }
+        if (!found || ((int32_t)(header.seq - kv_env.seq) > 0))
+        {
+            kv_env.active = i;
+            kv_env.seq = header.seq;
+            found = 1;
+        }
+    }
+
+    if (!found)
+    {
+        // blank store: format the first sector
+        if (KvErase(0))
+        {
+            return KV_ERR_NVM;
+        }
+        header.magic = KV_MAGIC;
+        header.seq = 0;
+        if (KvWrite(0, 0, &header, sizeof(header)))
+        {
+            return KV_ERR_NVM;
+        }
+        kv_env.active = 0;
+        kv_env.seq = 0;
+    }
+
+    return KvScan();
+}
+
+kvErr_t
+KvGet(uint8_t key, void *value, uint8_t *len)
+{
+    kvErr_t err;
+    uint8_t i;
+
+    if (key >= KV_KEY_NUM)
+    {
+        return KV_ERR_INVALID;
+    }
+    if (kv_env.index[key] == 0)
+    {
+        return KV_ERR_NOT_FOUND;
+    }
+
+    err = KvRecRead(kv_env.index[key]);
+    if (err)
+    {
+        return (err == KV_ERR_NVM) ? err : KV_ERR_INVALID;
+    }
+
+    if (kv_env.buf.rec.len < *len)
+    {
+        *len = kv_env.buf.rec.len;
+    }
+    for (i = 0; i < *len; i++)
+    {
+        ((uint8_t *)value)[i] = kv_env.buf.bytes[sizeof(struct kv_rec) + i];
+    }
+
+    return KV_OK;
+}
+
+kvErr_t
+KvSet(uint8_t key, void const *value, uint8_t len)
+{
+    uint8_t i;
+
+    if ((key >= KV_KEY_NUM) || (len == 0) || (len > KV_VALUE_MAX))
+    {
+        return KV_ERR_INVALID;
+    }
+
+    // do not wear the flash if the value did not change
+    if ((kv_env.index[key] != 0) && (KvRecRead(kv_env.index[key]) == KV_OK) &&
+        (kv_env.buf.rec.len == len))
+    {
+        for (i = 0; i < len; i++)
+        {
+            if (kv_env.buf.bytes[sizeof(struct kv_rec) + i] != ((uint8_t const *)value)[i])
+            {
+                break;
+            }
+        }
+        if (i == len)
+        {
+            return KV_OK;
+        }
+    }
+
+    kv_env.buf.rec.key = key;
+    kv_env.buf.rec.len = len;
+    for (i = 0; i < len; i++)
+    {
+        kv_env.buf.bytes[sizeof(struct kv_rec) + i] = ((uint8_t const *)value)[i];
+    }
+
+    return KvAppend();
+}
+
+kvErr_t
+KvDelete(uint8_t key)
+{
+    if (key >= KV_KEY_NUM)
+    {
+        return KV_ERR_INVALID;
+    }
+    if (kv_env.index[key] == 0)
+    {
+        return KV_OK;
+    }
+
+    kv_env.buf.rec.key = key;
+    kv_env.buf.rec.len = 0;
+
+    return KvAppend();
+}
@@ -0,0 +1,116 @@
+/*
+ * Persistent key/value store API
+ *
+ * The store is a log of records kept in a few dedicated sectors of the internal flash.
+ * Updating a key appends a new record, the sectors are used one after the other so
+ * that the erase cycles are spread evenly between them.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _KVSTORE_H_
+#define _KVSTORE_H_
+
+// standard includes
+#include <stdint.h>
+
+// for the NVM types
+#include "NVM.h"
+
+/// Size of a sector of the internal flash
+#define KV_SECTOR_SIZE  (0x1000)
+
+/// First sector used by the store (sector 31 is kept for the reserved data)
+#define KV_SECTOR_FIRST (28)
+
+/// Number of sectors used by the store
+#define KV_SECTOR_NUM   (3)
+
+/// Bitfield of the sectors used by the store (to be excluded from any mass erase)
+#define KV_SECTOR_MASK  (((1 << KV_SECTOR_NUM) - 1) << KV_SECTOR_FIRST)
+
+/// Number of keys handled by the store (keys are 0..KV_KEY_NUM-1)
+#define KV_KEY_NUM      (32)
+
+/// Maximum length of a value
+#define KV_VALUE_MAX    (64)
+
+/// Definition of the keys in the system
+enum
+{
+    /// Ring oscillator coarse and fine trims (2 bytes: ctune, ftune), see rosc_tune
+    KV_KEY_ROSC_TRIM = 0,
+    /// 32kHz XTAL frequency error (int32_t, ppm in Q8), see xtal32_tune
+    KV_KEY_XTAL32_TRIM,
+};
+
+/// Status returned by the store functions
+typedef enum
+{
+    KV_OK = 0,
+    /// The key has no value in the store
+    KV_ERR_NOT_FOUND,
+    /// The key or the length is out of range
+    KV_ERR_INVALID,
+    /// There is no more room in the store, even after compaction
+    KV_ERR_FULL,
+    /// An NVM access failed
+    KV_ERR_NVM
+} kvErr_t;
+
+/**
+ * Initialize the store.
+ *
+ * The sectors are scanned to find the most recent one and the RAM index is built from
+ * its records.  A record that was interrupted by a power failure is ignored.
+ * @param[in] type NVM type as returned by NVM_Detect
+ * @return KV_OK if the store is usable
+ * @warning The flash regulators must have been started (@ref FlashStartReg)
+ */
+extern kvErr_t
+KvInit(nvmType_t type);
+
+/**
+ * Read the value of a key.
+ * @param[in] key Key to read
+ * @param[out] value Buffer receiving the value
+ * @param[in,out] len Size of the buffer, updated with the length of the value
+ * @return KV_OK if the value was read
+ */
+extern kvErr_t
+KvGet(uint8_t key, void *value, uint8_t *len);
+
+/**
+ * Write the value of a key.
+ *
+ * The previous value stays valid until the new record is completely written.
+ * @param[in] key Key to write
+ * @param[in] value Value to write
+ * @param[in] len Length of the value (1 to @ref KV_VALUE_MAX)
+ * @return KV_OK if the value was written
+ */
+extern kvErr_t
+KvSet(uint8_t key, void const *value, uint8_t len);
+
+/**
+ * Remove a key from the store.
+ * @param[in] key Key to remove
+ * @return KV_OK if the key was removed or did not exist
+ */
+extern kvErr_t
+KvDelete(uint8_t key);
+
+#endif // _KVSTORE_H_
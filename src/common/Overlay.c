@@ -0,0 +1,173 @@
+/*
+ * Overlay loader implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "Overlay.h"
+
+// for the build ID and the overlays check
+#include "Crc.h"
+
+/// First word of the flash image ("OKOK")
+#define OVL_IMAGE_MAGIC (0x4B4F4B4F)
+
+/// First word of the overlay table ("OVLY")
+#define OVL_TABLE_MAGIC (0x594C564F)
+
+/// No overlay in the region
+#define OVL_NONE        (0xFF)
+
+// import symbols from the linker script
+extern char text_base, text_end;
+extern char overlay_base;
+extern char __load_start_OVL_0, __load_stop_OVL_0;
+extern char __load_start_OVL_1, __load_stop_OVL_1;
+extern char __load_start_OVL_2, __load_stop_OVL_2;
+extern char __load_start_OVL_3, __load_stop_OVL_3;
+
+/// Load address ranges of the overlays linked in the running image
+static char const * const ovl_linked[OVL_MAX][2] =
+{
+    {&__load_start_OVL_0, &__load_stop_OVL_0},
+    {&__load_start_OVL_1, &__load_stop_OVL_1},
+    {&__load_start_OVL_2, &__load_stop_OVL_2},
+    {&__load_start_OVL_3, &__load_stop_OVL_3},
+};
+
+/// Entry of the overlay table
+struct ovl_entry
+{
+    /// Address of the region
+    uint32_t addr;
+
+    /// Size of the overlay, 0 if empty
+    uint32_t size;
+
+    /// Address of the overlay in the flash
+    uint32_t flash;
+
+    /// CRC32 of the overlay
+    uint32_t crc;
+};
+
+/// Loader environment
+static struct ovl_env
+{
+    /// NVM type
+    nvmType_t type;
+
+    /// Number of overlays in the table, 0 if it is not usable
+    uint8_t count;
+
+    /// Overlay in the region
+    uint8_t current;
+
+    /// Overlay table
+    struct ovl_entry table[OVL_MAX];
+} ovl_env;
+
+ovlErr_t
+OverlayInit(nvmType_t type)
+{
+    uint32_t image[2], header[3], addr, size;
+    uint8_t id;
+
+    ovl_env.type = type;
+    ovl_env.count = 0;
+    ovl_env.current = OVL_NONE;
+
+    // the table follows the RAM image, word aligned
+    if (NVM_Read(gNvmInternalInterface_c, type, image, 0, sizeof(image)))
+    {
+        return OVL_ERR_NVM;
+    }
+    if (image[0] != OVL_IMAGE_MAGIC)
+    {
+        return OVL_ERR_NO_TABLE;
+    }
+    addr = (sizeof(image) + image[1] + 3) & ~3;
+
+    // header: magic, number of overlays and build ID
+    if (NVM_Read(gNvmInternalInterface_c, type, header, addr, sizeof(header)))
+    {
+        return OVL_ERR_NVM;
+    }
+    if ((header[0] != OVL_TABLE_MAGIC) || (header[1] > OVL_MAX))
+    {
+        return OVL_ERR_NO_TABLE;
+    }
+
+    // the table must have been built with the resident part of the running image
+    if (header[2] != ~Crc32(CRC32_INIT, &text_base, &text_end - &text_base))
+    {
+        return OVL_ERR_MISMATCH;
+    }
+    if (NVM_Read(gNvmInternalInterface_c, type, ovl_env.table, addr + sizeof(header),
+            header[1] * sizeof(struct ovl_entry)))
+    {
+        return OVL_ERR_NVM;
+    }
+
+    // the overlays linked must be the ones in the table, the missing ones being empty
+    for (id = 0; id < OVL_MAX; id++)
+    {
+        size = ovl_linked[id][1] - ovl_linked[id][0];
+        if (id >= header[1])
+        {
+            ovl_env.table[id].size = 0;
+        }
+        if ((ovl_env.table[id].size != size) ||
+            (size && (ovl_env.table[id].addr != (uint32_t)&overlay_base)))
+        {
+            return OVL_ERR_MISMATCH;
+        }
+    }
+
+    ovl_env.count = header[1];
+    return OVL_OK;
+}
+
+ovlErr_t
+OverlayLoad(uint8_t id)
+{
+    struct ovl_entry const *entry = &ovl_env.table[id];
+
+    if ((id >= ovl_env.count) || !entry->size)
+    {
+        return OVL_ERR_INVALID;
+    }
+    if (id == ovl_env.current)
+    {
+        return OVL_OK;
+    }
+
+    // the region holds no valid overlay until the read completes and is checked
+    ovl_env.current = OVL_NONE;
+    if (NVM_Read(gNvmInternalInterface_c, ovl_env.type, (void *)entry->addr, entry->flash,
+            entry->size))
+    {
+        return OVL_ERR_NVM;
+    }
+    if (entry->crc != ~Crc32(CRC32_INIT, (void const *)entry->addr, entry->size))
+    {
+        return OVL_ERR_CRC;
+    }
+
+    ovl_env.current = id;
+    return OVL_OK;
+}
@@ -0,0 +1,82 @@
+/*
+ * Overlay loader API
+ *
+ * The code and constants placed with __OVERLAY(n) are linked in a SRAM region shared by
+ * all the overlays (see RAMROM.lds) and stored in the flash image after the resident
+ * RAM image, with a table built by buildimages:
+ *     "OVLY" | number of overlays | overlays: address | size | flash address
+ * An overlay is copied with NVM_Read in the region before its functions are called, it
+ * replaces the overlay loaded before.  The overlays can neither call each other nor hold
+ * variables, and no interrupt handler may be placed in an overlay.  The overlay functions
+ * called from the resident code must be __NOINLINE.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _OVERLAY_H_
+#define _OVERLAY_H_
+
+// standard includes
+#include <stdint.h>
+
+// for the NVM types
+#include "NVM.h"
+
+/// Number of overlays (OVL_0 to OVL_3 sections in RAMROM.lds)
+#define OVL_MAX (4)
+
+/// Status returned by the overlay functions
+typedef enum
+{
+    OVL_OK = 0,
+    /// The flash holds no image or no overlay table
+    OVL_ERR_NO_TABLE,
+    /// The overlay table does not match the overlays linked in the running image
+    OVL_ERR_MISMATCH,
+    /// The data of the overlay read from the flash does not match its CRC
+    OVL_ERR_CRC,
+    /// The overlay does not exist or is empty
+    OVL_ERR_INVALID,
+    /// An NVM access failed
+    OVL_ERR_NVM
+} ovlErr_t;
+
+/**
+ * Initialize the loader.
+ *
+ * The overlay table is read from the flash image and checked against the running
+ * image: its build ID (CRC32 of the resident code and constants) and the overlays
+ * linked, so that an image loaded in RAM over a different flash image does not run
+ * foreign code.
+ * @param[in] type NVM type as returned by NVM_Detect
+ * @return OVL_OK if the overlays can be loaded
+ * @warning The flash regulators must have been started (@ref FlashStartReg)
+ */
+extern ovlErr_t
+OverlayInit(nvmType_t type);
+
+/**
+ * Load an overlay, nothing is read if it is the overlay loaded already.
+ *
+ * The data read is checked against the CRC32 of the overlay in the table.
+ * @param[in] id Overlay to load, the n of __OVERLAY(n)
+ * @return OVL_OK if the functions of the overlay can be called
+ * @warning Must not be called from an overlay
+ */
+extern ovlErr_t
+OverlayLoad(uint8_t id);
+
+#endif // _OVERLAY_H_
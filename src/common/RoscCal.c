@@ -0,0 +1,169 @@
+/*
+ * Ring oscillator calibration implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "RoscCal.h"
+
+// standard includes
+#include <stdbool.h>
+
+// for the time conversions
+#include "Time.h"
+
+// for the calibration counter and the trims
+#include "reg_crm.h"
+
+/// Current calibration
+static struct rosc_cal rosc_cal;
+
+/**
+ * Measure the ring oscillator with the current trims.
+ * @return Number of 24MHz cycles during ROSC_CAL_TICKS periods
+ */
+static uint32_t
+RoscCalMeasure(void)
+{
+    uint32_t rtc;
+
+    crm_ringosc_cntl_pack(rosc_cal.ctune, rosc_cal.ftune, 1);
+
+    // let the oscillator settle on the new trims for one period
+    rtc = crm_rtc_count_get();
+    while (crm_rtc_count_get() == rtc) ;
+
+    // count the reference clock during ROSC_CAL_TICKS periods
+    crm_status_set(CAL_DONE_BIT);
+    crm_cal_cntl_pack(0, 1, ROSC_CAL_TICKS);
+    while (!crm_cal_done_getf()) ;
+    rosc_cal.cycles = crm_cal_count_get();
+
+    // stop the calibration and clear the status
+    crm_cal_cntl_pack(0, 0, 0);
+    crm_status_set(CAL_DONE_BIT);
+
+    return rosc_cal.cycles;
+}
+
+/**
+ * Compute the distance of a measurement to the target.
+ * @param[in] cycles Measurement
+ * @return Absolute difference with ROSC_CAL_TARGET
+ */
+static uint32_t
+RoscCalError(uint32_t cycles)
+{
+    return (cycles > ROSC_CAL_TARGET) ? (cycles - ROSC_CAL_TARGET) :
+            (ROSC_CAL_TARGET - cycles);
+}
+
+/**
+ * Binary search of a trim, the other one being constant.
+ *
+ * The direction in which the trim moves the frequency is found from both ends of
+ * the range.
+ * @param[in,out] trim Trim to search (in rosc_cal)
+ * @param[in] max Maximum value of the trim
+ */
+static void
+RoscCalSearch(uint8_t *trim, uint8_t max)
+{
+    uint8_t low = 0, high = max;
+    uint32_t low_cycles, high_cycles, cycles;
+    bool rising;
+
+    *trim = low;
+    low_cycles = RoscCalMeasure();
+    *trim = high;
+    high_cycles = RoscCalMeasure();
+
+    // the number of cycles grows with the trim when the trim slows the oscillator down
+    rising = high_cycles > low_cycles;
+
+    while ((high - low) > 1)
+    {
+        *trim = (low + high) / 2;
+        cycles = RoscCalMeasure();
+        if ((cycles < ROSC_CAL_TARGET) == rising)
+        {
+            low = *trim;
+            low_cycles = cycles;
+        }
+        else
+        {
+            high = *trim;
+            high_cycles = cycles;
+        }
+    }
+
+    *trim = (RoscCalError(low_cycles) <= RoscCalError(high_cycles)) ? low : high;
+}
+
+struct rosc_cal const *
+RoscCalRun(void)
+{
+    rosc_cal.ftune = (ROSC_CAL_FTUNE_MAX + 1) / 2;
+    RoscCalSearch(&rosc_cal.ctune, ROSC_CAL_CTUNE_MAX);
+    RoscCalSearch(&rosc_cal.ftune, ROSC_CAL_FTUNE_MAX);
+
+    return RoscCalApply(rosc_cal.ctune, rosc_cal.ftune);
+}
+
+struct rosc_cal const *
+RoscCalTrack(void)
+{
+    uint8_t ftune = rosc_cal.ftune, best = rosc_cal.ftune;
+    uint32_t error, best_error;
+
+    best_error = RoscCalError(RoscCalMeasure());
+
+    // try the neighbor fine trims
+    if (ftune > 0)
+    {
+        rosc_cal.ftune = ftune - 1;
+        error = RoscCalError(RoscCalMeasure());
+        if (error < best_error)
+        {
+            best = rosc_cal.ftune;
+            best_error = error;
+        }
+    }
+    if (ftune < ROSC_CAL_FTUNE_MAX)
+    {
+        rosc_cal.ftune = ftune + 1;
+        error = RoscCalError(RoscCalMeasure());
+        if (error < best_error)
+        {
+            best = rosc_cal.ftune;
+            best_error = error;
+        }
+    }
+
+    return RoscCalApply(rosc_cal.ctune, best);
+}
+
+struct rosc_cal const *
+RoscCalApply(uint8_t ctune, uint8_t ftune)
+{
+    rosc_cal.ctune = ctune;
+    rosc_cal.ftune = ftune;
+    RoscCalMeasure();
+
+    TimeCalibrate(ROSC_CAL_TICKS, rosc_cal.cycles);
+    return &rosc_cal;
+}
@@ -0,0 +1,94 @@
+/*
+ * Ring oscillator calibration API
+ *
+ * The ring oscillator clocking the RTC is trimmed against the 24MHz reference with the
+ * CRM calibration counter: the coarse then the fine trims are found by binary search.
+ * The RTC tick rate measured is given to the time conversions (@ref TimeCalibrate).
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _ROSCCAL_H_
+#define _ROSCCAL_H_
+
+// standard includes
+#include <stdint.h>
+
+/// Target frequency of the ring oscillator (Hz)
+#define ROSC_CAL_FREQ  (2000)
+
+/// Number of ring oscillator periods of a measurement
+#define ROSC_CAL_TICKS (16)
+
+/// Number of 24MHz cycles expected during a measurement
+#define ROSC_CAL_TARGET ((24000000 / ROSC_CAL_FREQ) * ROSC_CAL_TICKS)
+
+/// Maximum value of the coarse trim
+#define ROSC_CAL_CTUNE_MAX (15)
+
+/// Maximum value of the fine trim
+#define ROSC_CAL_FTUNE_MAX (31)
+
+/// Calibration result
+struct rosc_cal
+{
+    /// Coarse trim
+    uint8_t ctune;
+
+    /// Fine trim
+    uint8_t ftune;
+
+    /// Number of 24MHz cycles during ROSC_CAL_TICKS periods with these trims
+    uint32_t cycles;
+};
+
+/**
+ * Calibrate the ring oscillator.
+ *
+ * The coarse trim is searched with the fine trim in the middle of its range, then the
+ * fine trim is searched.  The search takes about 12 measurements of ROSC_CAL_TICKS
+ * periods (around 100ms).  The best trims are applied and the time conversions are
+ * updated.
+ * @return The calibration result
+ * @warning Peripheral clock is expected to be 24MHz
+ */
+extern struct rosc_cal const *
+RoscCalRun(void);
+
+/**
+ * Follow the drift of the ring oscillator.
+ *
+ * The current fine trim and its two neighbors are measured, and the fine trim is moved
+ * by one step if this brings the frequency closer to the target.  The trim kept is
+ * measured again for the time conversions, so a call takes up to 4 measurements of
+ * ROSC_CAL_TICKS periods (around 30ms).  To be called periodically, as the temperature
+ * changes, after @ref RoscCalRun.
+ * @return The calibration result
+ */
+extern struct rosc_cal const *
+RoscCalTrack(void);
+
+/**
+ * Apply trims found by a previous calibration (e.g. stored in the persistent store)
+ * and update the time conversions.
+ * @param[in] ctune Coarse trim
+ * @param[in] ftune Fine trim
+ * @return The calibration result
+ */
+extern struct rosc_cal const *
+RoscCalApply(uint8_t ctune, uint8_t ftune);
+
+#endif // _ROSCCAL_H_
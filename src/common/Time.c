@@ -0,0 +1,80 @@
+/*
+ * Time related implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "Time.h"
+
+/// Number of peripheral clock cycles per millisecond
+#define TIME_CYCLES_PER_MS (24000)
+
+struct time_env time_env =
+{
+    // 32 ticks per millisecond
+    .ticks_per_ms = 32 << 16,
+    .ms_per_tick = 1 << (32 - 5),
+};
+
+/**
+ * Divide a 64 bits value by a 32 bits value (long division, there is no runtime
+ * library).
+ * @param[in] num Numerator
+ * @param[in] den Denominator (non null)
+ * @return The quotient, saturated to 32 bits
+ */
+static uint32_t
+TimeDivide(uint64_t num, uint32_t den)
+{
+    uint64_t rem = 0;
+    uint32_t quot = 0;
+    int i;
+
+    // the quotient does not fit in 32 bits
+    if ((num >> 32) >= den)
+    {
+        return 0xFFFFFFFF;
+    }
+
+    for (i = 63; i >= 0; i--)
+    {
+        rem = (rem << 1) | ((uint32_t) (num >> 63));
+        num <<= 1;
+        if (rem >= den)
+        {
+            rem -= den;
+            quot = (quot << 1) | 1;
+        }
+        else
+        {
+            quot <<= 1;
+        }
+    }
+    return quot;
+}
+
+void
+TimeCalibrate(uint32_t ticks, uint32_t cycles)
+{
+    uint64_t ms;
+
+    // duration of the measurement in milliseconds (Q16)
+    ms = TimeDivide(((uint64_t) cycles) << 16, TIME_CYCLES_PER_MS);
+
+    time_env.ticks_per_ms = TimeDivide(((uint64_t) ticks) << 32, (uint32_t) ms);
+    time_env.ms_per_tick = TimeDivide(ms << 16, ticks);
+}
@@ -30,6 +30,33 @@
 // for the RTC value
 #include "reg_crm.h"
 
+/// Milliseconds for the pads to settle after a pull-up change, see @ref TimeMsToTicksUp
+/// (until the RTC is calibrated, the 32kHz rate is assumed and the wait is longer with
+/// the 2kHz ring oscillator)
+#define TIME_PADS_SETTLE_MS (2)
+
+/// Conversion factors between the RTC ticks and the milliseconds
+struct time_env
+{
+    /// Number of RTC ticks per millisecond (Q16)
+    uint32_t ticks_per_ms;
+
+    /// Number of milliseconds per RTC tick (Q32)
+    uint32_t ms_per_tick;
+};
+
+extern struct time_env time_env;
+
+/**
+ * Update the conversion factors with a measurement of the RTC.
+ *
+ * By default, the RTC is expected to run at 32 ticks per millisecond.
+ * @param[in] ticks Number of RTC ticks measured (at least 1 tick per millisecond)
+ * @param[in] cycles Duration of the ticks, in 24MHz peripheral clock cycles
+ */
+extern void
+TimeCalibrate(uint32_t ticks, uint32_t cycles);
+
 /**
  * Get the current time value.
  * @return The current time value.
@@ -61,4 +88,46 @@ __INLINE bool TimeCmp(uint32_t newer, uint32_t older)
     return TimeDiff(newer, older) >= 0;
 }
 
+/**
+ * Wait until a time value is reached.
+ * @param[in] date Time value to wait for
+ */
+__INLINE void TimeWaitUntil(uint32_t date)
+{
+    while (!TimeCmp(TimeGet(), date)) ;
+}
+
+/**
+ * Convert milliseconds to RTC ticks.
+ * @param[in] ms Number of milliseconds
+ * @return The number of RTC ticks (rounded)
+ */
+__INLINE uint32_t TimeMsToTicks(uint32_t ms)
+{
+    return (uint32_t) (((((uint64_t) ms) * time_env.ticks_per_ms) + (1 << 15)) >> 16);
+}
+
+/**
+ * Convert milliseconds to RTC ticks for a minimum delay.
+ * @param[in] ms Number of milliseconds
+ * @return The number of RTC ticks (rounded up, at least 1)
+ */
+__INLINE uint32_t TimeMsToTicksUp(uint32_t ms)
+{
+    uint32_t ticks;
+
+    ticks = (uint32_t) (((((uint64_t) ms) * time_env.ticks_per_ms) + 0xFFFF) >> 16);
+    return ticks ? ticks : 1;
+}
+
+/**
+ * Convert RTC ticks to milliseconds.
+ * @param[in] ticks Number of RTC ticks
+ * @return The number of milliseconds (rounded)
+ */
+__INLINE uint32_t TimeTicksToMs(uint32_t ticks)
+{
+    return (uint32_t) (((((uint64_t) ticks) * time_env.ms_per_tick) + (1U << 31)) >> 32);
+}
+
 #endif // _TIME_H_
@@ -1,7 +1,8 @@
 /*
  * Timer related API implementation.
  *
- * This implementation in the MC13224V chip uses TMR0 and TMR1.
+ * This implementation in the MC13224V chip uses two TMR channels: a millisecond
+ * prescaler and a one shot counter of milliseconds cascaded on it.
  *
  *    Copyright (C) 2009 Louis Caron
  *
@@ -22,57 +23,60 @@
 // minimum include
 #include "Timer.h"
 
-// include the timers registers
-#include "reg_tmr0.h"
-#include "reg_tmr1.h"
+// for the TMR channels
+#include "Tmr.h"
 
-// for the debug interface
-#include "common/Uart1.h"
+/// Timer environment
+static struct timer_env
+{
+    /// Channel dividing the peripheral clock down to milliseconds
+    int8_t prescaler;
 
-void
-TimerInit(void)
+    /// Channel counting the milliseconds
+    int8_t counter;
+
+    /// Callback upon expiry
+    void (*expired)(void);
+} timer_env;
+
+/**
+ * Callback upon compare event of the milliseconds counter.
+ * @param[in] ch Channel
+ * @param[in] events Events that occurred
+ */
+static void
+TimerCallback(uint8_t ch, uint8_t events)
 {
-    // configure timer 0:
-    //    - count rising edges
-    //    - primary source = peripheral clock
-    //    - count repeatedly and reinitializes once compare reached
-    //    - count up
-    //    - no co_init and no OFLAG
-    tmr0_ctrl_pack(0, 8, 0, 0, 1, 0, 0, 0);
-    tmr0_sctrl_set(0);
-    tmr0_csctrl_set(0);
-    //    - upon compare reached, reload to 0
-    tmr0_load_set(0);
-    //    - count up to 24000 to count milliseconds
-    tmr0_comp1_set(24000);
+    // the counter stopped by itself, stop the prescaler as well
+    TmrStop(timer_env.prescaler);
 
-    // configure timer 1:
-    //    - count rising edges
-    //    - primary source = counter0 output
-    //    - count only once and stop
-    //    - count up
-    //    - no co_init and no OFLAG
-    tmr1_ctrl_pack(0, 4, 0, 1, 0, 0, 0, 0);
-    //    - enable interrupt upon successful compare
-    tmr1_sctrl_pack(0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-    tmr1_csctrl_set(0);
+    if (timer_env.expired)
+    {
+        timer_env.expired();
+    }
 }
 
-void
-TimerInt(void)
+bool
+TimerInit(void (*expired)(void))
 {
-    Uart1PutS("\nTMR FIQ: CTRL = 0x");
-    Uart1PutU16(TMR1_CTRL_REG);
-    Uart1PutS(", SCTRL = 0x");
-    Uart1PutU16(TMR1_SCTRL_REG);
-    Uart1PutS(", CSCTRL = 0x");
-    Uart1PutU16(TMR1_CSCTRL_REG);
+    int8_t prescaler, counter;
 
-    // clear the timer compare flag interrupt
-    tmr1_tcf_setf(0);
+    prescaler = TmrAlloc(TMR_ANY);
+    if (prescaler < 0)
+    {
+        return false;
+    }
+    counter = TmrAlloc(TMR_ANY);
+    if (counter < 0)
+    {
+        TmrRelease(prescaler);
+        return false;
+    }
 
-    Uart1PutS("\nTMR FIQ: SCTRL = 0x");
-    Uart1PutU16(TMR1_SCTRL_REG);
+    timer_env.prescaler = prescaler;
+    timer_env.counter = counter;
+    timer_env.expired = expired;
+    return true;
 }
 
 void
@@ -81,29 +85,22 @@ TimerStart(uint16_t delay)
     // by default, stop any current timer running
     TimerStop();
 
-    // set the delay in which the timer should expire
-    tmr1_comp1_set(delay);
-
-    // reinitialize the timer
-    tmr0_cntr_set(0);
-    tmr1_cntr_set(0);
-
-    // start timer 0 millisecond count
-    tmr0_count_mode_setf(1);
-    // start timer 1 single shot synchronous
-    tmr1_count_mode_setf(7);
+    // start the milliseconds counter single shot, then the prescaler counting 24000
+    // peripheral clock ticks
+    TmrStartCascade(timer_env.counter, timer_env.prescaler, delay, true,
+            timer_env.expired ? TimerCallback : NULL);
+    TmrStartCompare(timer_env.prescaler, TMR_SRC_CLK, 24000, false, NULL);
 }
 
 void
 TimerStop(void)
 {
-    // disable timers 0 and 1
-    tmr0_count_mode_setf(0);
-    tmr1_count_mode_setf(0);
+    TmrStop(timer_env.prescaler);
+    TmrStop(timer_env.counter);
 }
 
 uint16_t
 TimerGet(void)
 {
-    return tmr1_cntr_get();
+    return TmrGet(timer_env.counter);
 }
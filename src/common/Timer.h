@@ -24,20 +24,18 @@
 
 // standard includes
 #include <stdint.h>
+#include <stdbool.h>
 
 /**
- * Initialize the timer API.
+ * Initialize the timer API, allocating two TMR channels.
  *
+ * @param[in] expired Callback upon timer expiry, called from @ref TmrInt, NULL if the
+ * timer is only read
+ * @return true if the two channels were allocated, the timer must not be used otherwise
  * @warning Peripheral clock is expected to be 24MHz
  */
-extern void
-TimerInit(void);
-
-/**
- * Function to call upon TMR peripheral FIQ.
- */
-extern void
-TimerInt(void);
+extern bool
+TimerInit(void (*expired)(void));
 
 /**
  * Start a timer with a given delay.
@@ -0,0 +1,254 @@
+/*
+ * TMR channels driver implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "Tmr.h"
+
+// for the fields of the registers (identical for all the channels)
+#include "reg_tmr0.h"
+
+/// Count modes
+enum
+{
+    TMR_MODE_STOP = 0,
+    TMR_MODE_RISING = 1,
+    TMR_MODE_CASCADE = 7
+};
+
+/// Output mode toggling OFLAG on alternating compare registers
+#define TMR_OUTPUT_TOGGLE_ALT (4)
+
+/// Driver environment
+static struct tmr_env
+{
+    /// Bitfield of the allocated channels
+    uint8_t used;
+
+    /// Callbacks of the channels
+    tmr_callback_t cb[TMR_NUM];
+} tmr_env;
+
+/**
+ * Build the value of a control register, counting up.
+ * @param[in] mode Count mode
+ * @param[in] src Primary count source
+ * @param[in] sec Secondary count source
+ * @param[in] once Stop at compare
+ * @param[in] length Reinitialize the counter at compare
+ * @param[in] output Output mode
+ * @return The value of the register
+ */
+static uint16_t
+TmrCtrl(uint8_t mode, uint8_t src, uint8_t sec, bool once, bool length, uint8_t output)
+{
+    return (mode << COUNT_MODE_LSB) | (src << PRIMARY_CNT_SOURCE_LSB) |
+            (sec << SECONDARY_CNT_SOURCE_LSB) | (once ? ONCE_BIT : 0) |
+            (length ? LENGTH_BIT : 0) | (output << OUTPUT_MODE_LSB);
+}
+
+/**
+ * Reset a channel to a stopped counter at 0, without interrupt.
+ * @param[in] ch Channel
+ * @param[in] cb Callback of the channel
+ * @return The registers of the channel
+ */
+static struct tmr_regs *
+TmrReset(uint8_t ch, tmr_callback_t cb)
+{
+    struct tmr_regs *regs = TMR_REGS(ch);
+
+    regs->ctrl = 0;
+    regs->sctrl = 0;
+    regs->csctrl = 0;
+    regs->load = 0;
+    regs->cntr = 0;
+    tmr_env.cb[ch] = cb;
+
+    return regs;
+}
+
+/**
+ * Set the compare value of a channel for a number of source ticks.
+ * @param[in] regs Registers of the channel
+ * @param[in] ticks Number of source ticks before the compare event
+ * @param[in] once The counter stops at the compare value
+ */
+static void
+TmrCompare(struct tmr_regs *regs, uint16_t ticks, bool once)
+{
+    // a one shot counter stops on the compare value, a periodic one reloads 0 on the
+    // tick following the compare value
+    regs->comp1 = once ? ticks : ticks - 1;
+}
+
+int8_t
+TmrAlloc(uint8_t ch)
+{
+    int8_t i;
+
+    for (i = 0; i < TMR_NUM; i++)
+    {
+        if (((ch == TMR_ANY) || (ch == i)) && !(tmr_env.used & (1 << i)))
+        {
+            tmr_env.used |= 1 << i;
+            TmrReset(i, NULL);
+            return i;
+        }
+    }
+    return -1;
+}
+
+void
+TmrRelease(uint8_t ch)
+{
+    TmrReset(ch, NULL);
+    tmr_env.used &= ~(1 << ch);
+}
+
+void
+TmrSetCallback(uint8_t ch, tmr_callback_t cb)
+{
+    tmr_env.cb[ch] = cb;
+}
+
+void
+TmrStartCompare(uint8_t ch, uint8_t src, uint16_t ticks, bool once, tmr_callback_t cb)
+{
+    struct tmr_regs *regs = TmrReset(ch, cb);
+
+    TmrCompare(regs, ticks, once);
+    regs->sctrl = cb ? TCFIE_BIT : 0;
+    regs->ctrl = TmrCtrl(TMR_MODE_RISING, src, 0, once, !once, 0);
+}
+
+void
+TmrStartCascade(uint8_t ch, uint8_t from, uint16_t ticks, bool once, tmr_callback_t cb)
+{
+    struct tmr_regs *regs = TmrReset(ch, cb);
+
+    TmrCompare(regs, ticks, once);
+    regs->sctrl = cb ? TCFIE_BIT : 0;
+    regs->ctrl = TmrCtrl(TMR_MODE_CASCADE, TMR_SRC_OUTPUT(from), 0, once, !once, 0);
+}
+
+void
+TmrStartCapture(uint8_t ch, uint8_t src, enum tmr_edge edge, tmr_callback_t cb)
+{
+    struct tmr_regs *regs = TmrReset(ch, cb);
+
+    // count freely, capture on the input pin of the channel (secondary source)
+    regs->sctrl = (cb ? IEFIE_BIT : 0) | (edge << CAPTURE_MODE_LSB);
+    regs->ctrl = TmrCtrl(TMR_MODE_RISING, src, ch, false, false, 0);
+}
+
+void
+TmrStartPwm(uint8_t ch, uint8_t src, uint16_t high, uint16_t low)
+{
+    struct tmr_regs *regs = TmrReset(ch, NULL);
+
+    // the output starts low: count the low level with COMP2 first, then the high level
+    // with COMP1
+    regs->comp1 = high - 1;
+    regs->comp2 = low - 1;
+    regs->sctrl = OEN_BIT;
+    regs->ctrl = TmrCtrl(TMR_MODE_RISING, src, 0, false, true, TMR_OUTPUT_TOGGLE_ALT);
+}
+
+void
+TmrStop(uint8_t ch)
+{
+    TMR_REGS(ch)->ctrl &= ~COUNT_MODE_MASK;
+}
+
+uint16_t
+TmrGet(uint8_t ch)
+{
+    return TMR_REGS(ch)->cntr;
+}
+
+uint16_t
+TmrCapture(uint8_t ch)
+{
+    return TMR_REGS(ch)->capt;
+}
+
+void
+TmrInt(void)
+{
+    struct tmr_regs *regs;
+    uint16_t sctrl, csctrl, clear;
+    uint8_t ch, events;
+
+    for (ch = 0; ch < TMR_NUM; ch++)
+    {
+        if (!(tmr_env.used & (1 << ch)))
+        {
+            continue;
+        }
+        regs = TMR_REGS(ch);
+        events = 0;
+
+        // status flags with their interrupt enabled, cleared by writing 0 (the others
+        // are written to 1, they may have been raised since the read)
+        sctrl = regs->sctrl;
+        clear = 0;
+        if ((sctrl & TCF_BIT) && (sctrl & TCFIE_BIT))
+        {
+            events |= TMR_EVT_COMPARE;
+            clear |= TCF_BIT;
+        }
+        if ((sctrl & TOF_BIT) && (sctrl & TOFIE_BIT))
+        {
+            events |= TMR_EVT_OVERFLOW;
+            clear |= TOF_BIT;
+        }
+        if ((sctrl & IEF_BIT) && (sctrl & IEFIE_BIT))
+        {
+            events |= TMR_EVT_CAPTURE;
+            clear |= IEF_BIT;
+        }
+        if (clear)
+        {
+            regs->sctrl = (sctrl | TMR_SCTRL_FLAGS) & ~clear;
+        }
+
+        // compare load flags
+        csctrl = regs->csctrl;
+        clear = 0;
+        if ((csctrl & TCF1_BIT) && (csctrl & TCF1EN_BIT))
+        {
+            events |= TMR_EVT_COMPARE1;
+            clear |= TCF1_BIT;
+        }
+        if ((csctrl & TCF2_BIT) && (csctrl & TCF2EN_BIT))
+        {
+            events |= TMR_EVT_COMPARE2;
+            clear |= TCF2_BIT;
+        }
+        if (clear)
+        {
+            regs->csctrl = (csctrl | TMR_CSCTRL_FLAGS) & ~clear;
+        }
+
+        if (events && tmr_env.cb[ch])
+        {
+            tmr_env.cb[ch](ch, events);
+        }
+    }
+}
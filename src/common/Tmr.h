@@ -0,0 +1,195 @@
+/*
+ * TMR channels driver API
+ *
+ * The 4 channels of the TMR block are allocated to the modules that need them, and
+ * configured for the usual uses: compare (periodic or one shot), cascade, input
+ * capture and PWM.  The TMR interrupt is dispatched to a callback per channel.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TMR_H_
+#define _TMR_H_
+
+// standard includes
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/// Number of TMR channels
+#define TMR_NUM (4)
+
+/// Channel number to pass to @ref TmrAlloc to get any free channel
+#define TMR_ANY (0xFF)
+
+/// Counter source: input pin of channel n
+#define TMR_SRC_INPUT(n)       (n)
+/// Counter source: output of channel n
+#define TMR_SRC_OUTPUT(n)      (4 + (n))
+/// Counter source: peripheral clock
+#define TMR_SRC_CLK            (8)
+/// Counter source: peripheral clock divided by 2^n (n = 1..7)
+#define TMR_SRC_CLK_DIV(n)     (8 + (n))
+
+/// Event: the counter reached the compare value (COMP1 when counting up)
+#define TMR_EVT_COMPARE  (1 << 0)
+/// Event: the counter rolled over
+#define TMR_EVT_OVERFLOW (1 << 1)
+/// Event: an edge was captured
+#define TMR_EVT_CAPTURE  (1 << 2)
+/// Event: the counter reached COMP1 (compare load mode)
+#define TMR_EVT_COMPARE1 (1 << 3)
+/// Event: the counter reached COMP2 (compare load mode)
+#define TMR_EVT_COMPARE2 (1 << 4)
+
+/// Edges captured by @ref TmrStartCapture
+enum tmr_edge
+{
+    TMR_EDGE_RISING = 1,
+    TMR_EDGE_FALLING,
+    TMR_EDGE_BOTH
+};
+
+/// Registers of a channel, for the uses that are not covered by the driver
+struct tmr_regs
+{
+    volatile uint16_t comp1;
+    volatile uint16_t comp2;
+    volatile uint16_t capt;
+    volatile uint16_t load;
+    volatile uint16_t hold;
+    volatile uint16_t cntr;
+    volatile uint16_t ctrl;
+    volatile uint16_t sctrl;
+    volatile uint16_t cmpld1;
+    volatile uint16_t cmpld2;
+    volatile uint16_t csctrl;
+};
+
+/// Get the registers of a channel
+#define TMR_REGS(ch) ((struct tmr_regs *)(0x80007000 + ((ch) * 0x20)))
+
+/// Status flags of SCTRL and CSCTRL (fields of reg_tmr0.h), cleared by writing 0: a
+/// read-modify-write must write them to 1 so that a flag raised in between is kept
+#define TMR_SCTRL_FLAGS  (TCF_BIT | TOF_BIT | IEF_BIT)
+#define TMR_CSCTRL_FLAGS (TCF1_BIT | TCF2_BIT)
+
+/**
+ * Callback upon channel interrupt.
+ * @param[in] ch Channel
+ * @param[in] events Events that occurred (TMR_EVT_*), their flags are already cleared
+ */
+typedef void (*tmr_callback_t)(uint8_t ch, uint8_t events);
+
+/**
+ * Allocate a channel.
+ * @param[in] ch Channel to allocate, or TMR_ANY
+ * @return The channel allocated, -1 if it is not free
+ */
+extern int8_t
+TmrAlloc(uint8_t ch);
+
+/**
+ * Stop a channel, disable its interrupts and make it free.
+ * @param[in] ch Channel
+ */
+extern void
+TmrRelease(uint8_t ch);
+
+/**
+ * Set the callback of a channel, for channels configured through @ref TMR_REGS.
+ * @param[in] ch Channel
+ * @param[in] cb Callback upon the enabled interrupts
+ */
+extern void
+TmrSetCallback(uint8_t ch, tmr_callback_t cb);
+
+/**
+ * Start counting up to a compare value.
+ * @param[in] ch Channel
+ * @param[in] src Counter source (TMR_SRC_*)
+ * @param[in] ticks Number of source ticks before the compare event
+ * @param[in] once Stop at the compare event, otherwise restart from 0
+ * @param[in] cb Callback upon compare event, NULL to disable the interrupt
+ */
+extern void
+TmrStartCompare(uint8_t ch, uint8_t src, uint16_t ticks, bool once, tmr_callback_t cb);
+
+/**
+ * Start counting the compare events of another channel.
+ * @param[in] ch Channel
+ * @param[in] from Channel generating the events
+ * @param[in] ticks Number of events before the compare event
+ * @param[in] once Stop at the compare event, otherwise restart from 0
+ * @param[in] cb Callback upon compare event, NULL to disable the interrupt
+ */
+extern void
+TmrStartCascade(uint8_t ch, uint8_t from, uint16_t ticks, bool once, tmr_callback_t cb);
+
+/**
+ * Start capturing the counter on the edges of the channel input pin.
+ *
+ * The counter counts freely, the captured value is read with @ref TmrCapture.
+ * @param[in] ch Channel
+ * @param[in] src Counter source (TMR_SRC_*)
+ * @param[in] edge Edges to capture
+ * @param[in] cb Callback upon capture, NULL to disable the interrupt
+ */
+extern void
+TmrStartCapture(uint8_t ch, uint8_t src, enum tmr_edge edge, tmr_callback_t cb);
+
+/**
+ * Start a PWM on the channel output pin.
+ *
+ * The output toggles when the counter reaches alternately COMP1 and COMP2.
+ * @param[in] ch Channel
+ * @param[in] src Counter source (TMR_SRC_*)
+ * @param[in] high Number of source ticks at high level
+ * @param[in] low Number of source ticks at low level
+ */
+extern void
+TmrStartPwm(uint8_t ch, uint8_t src, uint16_t high, uint16_t low);
+
+/**
+ * Stop the counter of a channel, the configuration is kept.
+ * @param[in] ch Channel
+ */
+extern void
+TmrStop(uint8_t ch);
+
+/**
+ * Get the counter of a channel.
+ * @param[in] ch Channel
+ * @return The counter value
+ */
+extern uint16_t
+TmrGet(uint8_t ch);
+
+/**
+ * Get the last value captured by a channel.
+ * @param[in] ch Channel
+ * @return The captured counter value
+ */
+extern uint16_t
+TmrCapture(uint8_t ch);
+
+/**
+ * Function to call upon TMR peripheral interrupt.
+ */
+extern void
+TmrInt(void);
+
+#endif // _TMR_H_
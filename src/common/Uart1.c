@@ -21,9 +21,39 @@
 
 #include "reg_uart1.h"
 
+/// Size of the TX and RX FIFOs
+#define UART1_FIFO_SIZE (32)
+
 static const char nibble[16] =
     {'0','1','2','3','4','5','6','7', '8','9','A','B','C','D','E','F'};
 
+/// Transfers handled under interrupt
+static struct uart1_env
+{
+    /// Next char to send
+    uint8_t const *tx;
+    /// Number of chars left to send
+    volatile uint32_t txlen;
+    /// Reception buffer
+    uint8_t *rx;
+    /// Size of the reception buffer
+    uint32_t rxlen;
+    /// Number of chars received in the buffer
+    volatile uint32_t rxcnt;
+} uart1_env;
+
+/**
+ * Program the RX FIFO threshold for the chars left to receive.
+ */
+static void
+Uart1RxThreshold(void)
+{
+    uint32_t left = uart1_env.rxlen - uart1_env.rxcnt;
+
+    // interrupt when half of the FIFO is used, or when the last chars are there
+    uart1_urxcon_set((left < (UART1_FIFO_SIZE / 2)) ? left : (UART1_FIFO_SIZE / 2));
+}
+
 void
 Uart1Init(void)
 {
@@ -97,5 +127,86 @@ Uart1GetC(void)
     while (uart1_urxcon_get() == 0) ;
 
     // return the char
-    return (char)uart1_udata_getf();
+    return (char)uart1_udata_get();
+}
+
+void
+Uart1WriteStart(void const *buf, uint32_t len)
+{
+    uart1_env.tx = buf;
+    uart1_env.txlen = len;
+
+    if (len)
+    {
+        // interrupt when half of the TX FIFO is free
+        uart1_utxcon_set(UART1_FIFO_SIZE / 2);
+        uart1_mtxr_setf(0);
+    }
+}
+
+bool
+Uart1WriteDone(void)
+{
+    return uart1_env.txlen == 0;
+}
+
+void
+Uart1ReadStart(void *buf, uint32_t len)
+{
+    uart1_env.rx = buf;
+    uart1_env.rxlen = len;
+    uart1_env.rxcnt = 0;
+
+    if (len)
+    {
+        Uart1RxThreshold();
+        uart1_mrxr_setf(0);
+    }
+}
+
+uint32_t
+Uart1ReadCount(void)
+{
+    return uart1_env.rxcnt;
+}
+
+void
+Uart1Int(void)
+{
+    if (uart1_env.txlen)
+    {
+        uint32_t room = uart1_utxcon_get();
+
+        // fill the TX FIFO
+        while (room-- && uart1_env.txlen)
+        {
+            uart1_udata_set(*uart1_env.tx++);
+            uart1_env.txlen--;
+        }
+        if (uart1_env.txlen == 0)
+        {
+            // mask the TX interrupt
+            uart1_mtxr_setf(1);
+        }
+    }
+
+    if (uart1_env.rxcnt < uart1_env.rxlen)
+    {
+        uint32_t level = uart1_urxcon_get();
+
+        // empty the RX FIFO
+        while (level-- && (uart1_env.rxcnt < uart1_env.rxlen))
+        {
+            uart1_env.rx[uart1_env.rxcnt++] = uart1_udata_get();
+        }
+        if (uart1_env.rxcnt == uart1_env.rxlen)
+        {
+            // mask the RX interrupt
+            uart1_mrxr_setf(1);
+        }
+        else
+        {
+            Uart1RxThreshold();
+        }
+    }
 }
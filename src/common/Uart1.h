@@ -22,6 +22,7 @@
 
 // standard includes
 #include <stdint.h>
+#include <stdbool.h>
 
 /**
  * Initialize the UART peripheral.
@@ -77,5 +78,49 @@ Uart1PutU32(uint32_t v);
 extern char
 Uart1GetC(void);
 
+/**
+ * Start sending a buffer under interrupt.
+ *
+ * The buffer must not be modified until @ref Uart1WriteDone returns true, and no other
+ * function sending chars must be called in the meantime.
+ * @param buf Buffer to send
+ * @param len Number of chars to send
+ */
+extern void
+Uart1WriteStart(void const *buf, uint32_t len);
+
+/**
+ * Check if the buffer passed to @ref Uart1WriteStart was completely pushed into the FIFO.
+ * @return True if the transfer is over
+ */
+extern bool
+Uart1WriteDone(void);
+
+/**
+ * Start receiving a buffer under interrupt.
+ *
+ * No other function receiving chars must be called until the buffer is full.
+ * @param buf Buffer to fill
+ * @param len Number of chars to receive
+ */
+extern void
+Uart1ReadStart(void *buf, uint32_t len);
+
+/**
+ * Get the number of chars received in the buffer passed to @ref Uart1ReadStart.
+ * @return Number of chars received so far
+ */
+extern uint32_t
+Uart1ReadCount(void);
+
+/**
+ * Function to call upon UART1 peripheral interrupt.
+ *
+ * When the UART1 interrupt is not enabled in the ITC, this function can also be called
+ * periodically to move the chars between the FIFOs and the buffers.
+ */
+extern void
+Uart1Int(void);
+
 
 #endif // _UART1_H_
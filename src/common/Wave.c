@@ -0,0 +1,207 @@
+/*
+ * Waveform generator implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "Wave.h"
+
+// for the TMR channels
+#include "Tmr.h"
+
+// for the fields of the registers (identical for all the channels)
+#include "reg_tmr0.h"
+
+// for the critical sections
+#include "proc/proc.h"
+
+/// Output mode toggling OFLAG upon the compares, alternately with COMP1 and COMP2
+#define WAVE_OUTPUT_TOGGLE_ALT (4)
+
+/// Generator environment
+static struct wave_env
+{
+    /// Channel generating the waveform
+    uint8_t ch;
+
+    /// Segments generated
+    struct wave_segment const *segs;
+    uint8_t count;
+
+    /// Segments to generate once the current sequence is complete
+    struct wave_segment const *next_segs;
+    uint8_t next_count;
+
+    /// Last segment whose end was preloaded
+    uint8_t index;
+
+    /// Compare register of the next edge (0 for COMP1, 1 for COMP2)
+    uint8_t comp;
+
+    /// Counter value at the end of the last segment preloaded
+    uint16_t end;
+} wave_env;
+
+/**
+ * Check that the levels of a sequence alternate, also from its last segment to its
+ * first one.
+ * @param[in] segs Segments
+ * @param[in] count Number of segments
+ * @return true if the sequence can be generated by toggling the output
+ */
+static bool
+WaveValid(struct wave_segment const *segs, uint8_t count)
+{
+    uint8_t i;
+
+    if ((count < 2) || (count & 1))
+    {
+        return false;
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (!segs[i].ticks ||
+                (!segs[i].level == !segs[(i + 1 < count) ? i + 1 : 0].level))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Get the end of the segment following the last one preloaded.
+ * @return The counter value at the end of that segment
+ */
+static uint16_t
+WaveNext(void)
+{
+    uint8_t next = wave_env.index + 1;
+
+    if (next >= wave_env.count)
+    {
+        // the sequence is complete, switch the segments if requested
+        next = 0;
+        wave_env.segs = wave_env.next_segs;
+        wave_env.count = wave_env.next_count;
+    }
+
+    // the counter rolls over freely
+    wave_env.end += wave_env.segs[next].ticks;
+    wave_env.index = next;
+    return wave_env.end;
+}
+
+/**
+ * Callback upon compare events of the channel.
+ *
+ * Upon a compare, the compare register was loaded from its CMPLD register with the end
+ * of the segment after next, so the CMPLD register can take the end of the segment
+ * following that one.  When the interrupt was late enough for both compares to occur,
+ * they are handled in the order of the edges.
+ * @param[in] ch Channel
+ * @param[in] events Events that occurred
+ */
+static void
+WaveCallback(uint8_t ch, uint8_t events)
+{
+    struct tmr_regs *regs = TMR_REGS(ch);
+    uint8_t i;
+
+    for (i = 0; i < 2; i++)
+    {
+        if (!wave_env.comp && (events & TMR_EVT_COMPARE1))
+        {
+            regs->cmpld1 = WaveNext();
+            events &= ~TMR_EVT_COMPARE1;
+            wave_env.comp = 1;
+        }
+        else if (wave_env.comp && (events & TMR_EVT_COMPARE2))
+        {
+            regs->cmpld2 = WaveNext();
+            events &= ~TMR_EVT_COMPARE2;
+            wave_env.comp = 0;
+        }
+    }
+}
+
+bool
+WaveStart(uint8_t ch, uint8_t src, struct wave_segment const *segs, uint8_t count)
+{
+    struct tmr_regs *regs;
+
+    if (!WaveValid(segs, count) || (TmrAlloc(ch) < 0))
+    {
+        return false;
+    }
+    regs = TMR_REGS(ch);
+
+    wave_env.ch = ch;
+    wave_env.segs = segs;
+    wave_env.count = count;
+    wave_env.next_segs = segs;
+    wave_env.next_count = count;
+
+    // start with the level of the first segment
+    regs->sctrl = OEN_BIT | FORCE_BIT | (segs[0].level ? VAL_BIT : 0);
+
+    // the ends of the first two segments are compared, the two following ones are
+    // preloaded
+    wave_env.index = 0;
+    wave_env.end = segs[0].ticks;
+    wave_env.comp = 0;
+    regs->comp1 = wave_env.end;
+    regs->comp2 = WaveNext();
+    regs->cmpld1 = WaveNext();
+    regs->cmpld2 = WaveNext();
+
+    // reload COMP1 from CMPLD1 and COMP2 from CMPLD2 upon their compare, with an
+    // interrupt
+    TmrSetCallback(ch, WaveCallback);
+    regs->csctrl = TCF1EN_BIT | TCF2EN_BIT | (1 << CL1_LSB) | (2 << CL2_LSB);
+
+    // count rising edges of the source, repeatedly and rolling over, and toggle the
+    // output upon the compares
+    regs->ctrl = (src << PRIMARY_CNT_SOURCE_LSB) |
+            (WAVE_OUTPUT_TOGGLE_ALT << OUTPUT_MODE_LSB);
+    regs->ctrl |= (1 << COUNT_MODE_LSB);
+
+    return true;
+}
+
+bool
+WaveSet(struct wave_segment const *segs, uint8_t count)
+{
+    // the output keeps toggling, the new sequence must start with the same level
+    if (!WaveValid(segs, count) || (!segs[0].level != !wave_env.next_segs[0].level))
+    {
+        return false;
+    }
+
+    // the interrupt must not see the segments without their count
+    PROC_INT_DISABLE();
+    wave_env.next_segs = segs;
+    wave_env.next_count = count;
+    PROC_INT_RESTORE();
+    return true;
+}
+
+void
+WaveStop(void)
+{
+    TmrRelease(wave_env.ch);
+}
@@ -0,0 +1,80 @@
+/*
+ * Waveform generator API
+ *
+ * A repeated sequence of segments (level, duration) is generated on the output pin of
+ * a TMR channel.  The edges are produced by the channel compare output, which toggles
+ * upon COMP1 and COMP2 alternately, both reloaded by the hardware from CMPLD1 and
+ * CMPLD2.  The interrupt upon each compare only preloads the end of the segment after
+ * next in the CMPLD register used, so the edges do not depend on the interrupt latency
+ * as long as the interrupt is served within two segments.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _WAVE_H_
+#define _WAVE_H_
+
+// standard includes
+#include <stdint.h>
+#include <stdbool.h>
+
+/// Segment of a waveform
+struct wave_segment
+{
+    /// Output level during the segment
+    uint8_t level;
+
+    /// Duration of the segment in counter source ticks
+    uint16_t ticks;
+};
+
+/**
+ * Allocate a channel and start generating a waveform on its output pin.
+ *
+ * The segments are generated in sequence, and repeated forever.  The output toggles at
+ * the end of each segment, so the levels of the segments must alternate, also from the
+ * last segment to the first one (the number of segments is even).
+ * @param[in] ch Channel (the pin must be configured for the TMR function)
+ * @param[in] src Counter source (TMR_SRC_*)
+ * @param[in] segs Segments of the waveform, must stay valid while generated
+ * @param[in] count Number of segments, at least 2
+ * @return true if the segments are valid and the channel was allocated
+ * @warning The TMR interrupt latency must stay below the duration of the two shortest
+ * consecutive segments, and the TMR interrupt must be enabled in the ITC and call
+ * @ref TmrInt.
+ */
+extern bool
+WaveStart(uint8_t ch, uint8_t src, struct wave_segment const *segs, uint8_t count);
+
+/**
+ * Change the waveform generated.
+ *
+ * The new segments are used once the current sequence is complete, without glitch.
+ * Their levels must alternate as for @ref WaveStart, starting with the same level.
+ * @param[in] segs Segments of the waveform, must stay valid while generated
+ * @param[in] count Number of segments, at least 2
+ * @return true if the segments are valid
+ */
+extern bool
+WaveSet(struct wave_segment const *segs, uint8_t count);
+
+/**
+ * Stop generating the waveform and release the channel.
+ */
+extern void
+WaveStop(void);
+
+#endif // _WAVE_H_
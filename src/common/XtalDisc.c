@@ -0,0 +1,84 @@
+/*
+ * 32kHz crystal discipline implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "XtalDisc.h"
+
+// for the time conversions
+#include "Time.h"
+
+// for the calibration counter
+#include "reg_crm.h"
+
+/// Discipline state
+static struct xtal_disc xtal_disc;
+
+void
+XtalDiscStart(void)
+{
+    xtal_disc.samples = 0;
+
+    // start the calibration counter with the interrupt upon completion
+    crm_cal_cntl_pack(0, 0, 0);
+    crm_status_set(CAL_DONE_BIT);
+    crm_cal_cntl_pack(1, 1, XTAL_DISC_TICKS);
+}
+
+void
+XtalDiscStop(void)
+{
+    crm_cal_cntl_pack(0, 0, 0);
+    crm_status_set(CAL_DONE_BIT);
+}
+
+void
+XtalDiscInt(void)
+{
+    int32_t error;
+
+    // read the measurement and restart the counter for the next one
+    xtal_disc.cycles = crm_cal_count_get();
+    crm_cal_cntl_pack(1, 0, XTAL_DISC_TICKS);
+    crm_status_set(CAL_DONE_BIT);
+    crm_cal_cntl_pack(1, 1, XTAL_DISC_TICKS);
+
+    // first order low pass filter, initialized with the first measurement
+    if (xtal_disc.samples++ == 0)
+    {
+        xtal_disc.filtered = xtal_disc.cycles << 4;
+    }
+    else
+    {
+        error = (int32_t) ((xtal_disc.cycles << 4) - xtal_disc.filtered);
+        xtal_disc.filtered += error >> XTAL_DISC_FILTER_LOG2;
+    }
+
+    // frequency error, 24 cycles per ppm: ppm (Q8) = cycles (Q4) * 16/24 ~ 10923/2^14
+    error = (int32_t) ((XTAL_DISC_TARGET << 4) - xtal_disc.filtered);
+    xtal_disc.ppm = (int32_t) ((((int64_t) error) * 10923) >> 14);
+
+    // the delays in RTC ticks follow the crystal
+    TimeCalibrate(XTAL_DISC_TICKS, xtal_disc.filtered >> 4);
+}
+
+struct xtal_disc const *
+XtalDiscGet(void)
+{
+    return &xtal_disc;
+}
@@ -0,0 +1,89 @@
+/*
+ * 32kHz crystal discipline API
+ *
+ * The RTC clocked by the 32kHz crystal is measured continuously against the 24MHz
+ * reference with the CRM calibration counter.  The measurements are filtered and the
+ * result is given to the time conversions (@ref TimeCalibrate), so that the delays
+ * expressed in RTC ticks follow the actual crystal frequency.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _XTALDISC_H_
+#define _XTALDISC_H_
+
+// standard includes
+#include <stdint.h>
+
+/// Nominal frequency of the crystal (Hz)
+#define XTAL_DISC_FREQ   (32768)
+
+/// Number of RTC ticks of a measurement (1 second)
+#define XTAL_DISC_TICKS  (XTAL_DISC_FREQ)
+
+/// Number of 24MHz cycles expected during a measurement
+#define XTAL_DISC_TARGET (24000000)
+
+/// Weight of a new measurement in the filter (1/2^XTAL_DISC_FILTER_LOG2)
+#define XTAL_DISC_FILTER_LOG2 (3)
+
+/// State of the discipline
+struct xtal_disc
+{
+    /// Number of measurements done
+    volatile uint32_t samples;
+
+    /// Last measurement (24MHz cycles during XTAL_DISC_TICKS)
+    uint32_t cycles;
+
+    /// Filtered measurement (Q4)
+    uint32_t filtered;
+
+    /// Frequency error of the crystal, from the filtered measurement (ppm, Q8)
+    int32_t ppm;
+};
+
+/**
+ * Start measuring the crystal.
+ *
+ * The CRM calibration counter is started with its interrupt enabled, and restarted
+ * by @ref XtalDiscInt after each measurement.
+ * @warning The CRM interrupt must be enabled in the ITC, the RTC must be clocked by the
+ * 32kHz crystal and the peripheral clock is expected to be 24MHz
+ */
+extern void
+XtalDiscStart(void);
+
+/**
+ * Stop measuring the crystal, the time conversions keep the last correction.
+ */
+extern void
+XtalDiscStop(void);
+
+/**
+ * Function to call upon CRM interrupt, when the calibration is done.
+ */
+extern void
+XtalDiscInt(void);
+
+/**
+ * Get the state of the discipline.
+ * @return Pointer to the state, updated after each measurement
+ */
+extern struct xtal_disc const *
+XtalDiscGet(void);
+
+#endif // _XTALDISC_H_
@@ -44,4 +44,16 @@
 /// define the FIQ handler attribute for this compiler
 #define __FIQ __attribute__((__interrupt__("FIQ")))
 
+/// define the attribute grouping the hot code in SRAM (EXEC_RAM_FUNC section)
+#define __RAMFUNC __attribute__((__section__(".ramfunc")))
+
+/// define the attribute preventing the inlining of a function, e.g. of an overlay function
+/// in the resident code calling it
+#define __NOINLINE __attribute__((__noinline__))
+
+/// define the attribute placing code or constants in an overlay (OVL_n sections), n can be
+/// a macro naming the overlay
+#define __OVERLAY(n) __OVERLAY_SECTION(n)
+#define __OVERLAY_SECTION(n) __attribute__((__section__(".overlay." #n)))
+
 #endif // _COMPILER_H_
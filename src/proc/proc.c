@@ -0,0 +1,115 @@
+/*
+ * Processor related implementation: CPSR access for Thumb, critical sections accounting
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// minimum include
+#include "proc.h"
+
+// this file is built in ARM mode, it gives the CPSR access to the Thumb code
+proc_int_state_t
+proc_int_mask_arm(void)
+{
+    return proc_int_mask();
+}
+
+void
+proc_int_unmask_arm(proc_int_state_t state)
+{
+    proc_int_unmask(state);
+}
+
+#ifdef PROC_INT_DEBUG
+
+// for the timestamps
+#include "common/Clock.h"
+
+/// Critical sections environment
+static struct proc_env
+{
+    /// Date of the outermost disable
+    uint32_t start;
+
+    /// Location of the outermost disable
+    char const *file;
+    uint16_t line;
+
+    /// Statistics
+    struct proc_int_stats stats;
+} proc_env;
+
+proc_int_state_t
+proc_int_disable_debug(char const *file, uint16_t line)
+{
+    proc_int_state_t state = proc_int_mask();
+
+    // only the outermost critical section is measured
+    if (state != PROC_INT_MASK)
+    {
+        proc_env.start = ClockGet32();
+        proc_env.file = file;
+        proc_env.line = line;
+    }
+
+    return state;
+}
+
+void
+proc_int_restore_debug(proc_int_state_t state)
+{
+    uint32_t elapsed;
+
+    if (state != PROC_INT_MASK)
+    {
+        elapsed = ClockGet32() - proc_env.start;
+        if (elapsed > proc_env.stats.max)
+        {
+            proc_env.stats.max = elapsed;
+            proc_env.stats.file = proc_env.file;
+            proc_env.stats.line = proc_env.line;
+        }
+        if (elapsed > CLOCK_US(PROC_INT_BUDGET_US))
+        {
+            proc_env.stats.overruns++;
+        }
+    }
+
+    proc_int_unmask(state);
+}
+
+void
+proc_int_stats_get(struct proc_int_stats *stats)
+{
+    proc_int_state_t state = proc_int_mask();
+
+    *stats = proc_env.stats;
+    proc_int_unmask(state);
+}
+
+void
+proc_int_stats_reset(void)
+{
+    proc_int_state_t state = proc_int_mask();
+
+    proc_env.stats.max = 0;
+    proc_env.stats.file = "";
+    proc_env.stats.line = 0;
+    proc_env.stats.overruns = 0;
+    proc_int_unmask(state);
+}
+
+#endif // PROC_INT_DEBUG
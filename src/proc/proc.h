@@ -27,58 +27,157 @@
 
 #include <stdint.h>
 
-/** @brief Enable interrupts globally in the system.
+// for the inlining directive
+#include "compiler.h"
+
+/// Interrupt bits of the CPSR (IRQ and FIQ)
+#define PROC_INT_MASK (0xC0)
+
+/// Interrupt state saved by @ref proc_int_disable
+typedef uint32_t proc_int_state_t;
+
+/** @brief Out of line primitives, built in ARM mode for the Thumb code (proc.c).
+ */
+extern proc_int_state_t
+proc_int_mask_arm(void);
+extern void
+proc_int_unmask_arm(proc_int_state_t state);
+
+#ifndef __thumb__
+
+/** @brief Disable interrupts (IRQ and FIQ), without the debug accounting.
+ * @return Previous state of the interrupts, to pass to @ref proc_int_unmask
+ */
+__INLINE proc_int_state_t proc_int_mask(void)
+{
+    uint32_t cpsr;
+
+    __asm volatile("MRS %0, CPSR" : "=r"(cpsr));
+    __asm volatile("MSR CPSR_c, %0" : : "r"(cpsr | PROC_INT_MASK) : "memory");
+
+    return cpsr & PROC_INT_MASK;
+}
+
+/** @brief Restore interrupts, without the debug accounting.
+ * @param[in] state State returned by @ref proc_int_mask
+ */
+__INLINE void proc_int_unmask(proc_int_state_t state)
+{
+    uint32_t cpsr;
+
+    __asm volatile("MRS %0, CPSR" : "=r"(cpsr));
+    __asm volatile("MSR CPSR_c, %0" : : "r"((cpsr & ~PROC_INT_MASK) | state) : "memory");
+}
+
+#else // __thumb__
+
+// Thumb-1 has no access to the CPSR, the primitives are called in ARM mode
+#define proc_int_mask() proc_int_mask_arm()
+#define proc_int_unmask(__s) proc_int_unmask_arm(__s)
+
+#endif // __thumb__
+
+/** @brief Enable interrupts (IRQ and FIQ) globally in the system.
  * This macro must be used when the initialization phase is over and the interrupts
  * can start being handled by the system.
  */
 #define PROC_INT_START()                                                    \
 do {                                                                        \
-    uint32_t __l_cpsr_tmp;                                                  \
-    __asm volatile("MRS %0, CPSR" : "=r"(__l_cpsr_tmp));                    \
-    __asm volatile("BIC %0, %1, #0x40" : "=r"(__l_cpsr_tmp) :               \
-                 "r"(__l_cpsr_tmp));                                        \
-    __asm volatile("MSR CPSR_cxsf, %0" : : "r"(__l_cpsr_tmp));              \
+    proc_int_unmask(0);                                                     \
 } while(0)
 
-/** @brief Disable interrupts globally in the system.
+/** @brief Disable interrupts (IRQ and FIQ) globally in the system.
  * This macro must be used when the system wants to disable all the interrupt
  * it could handle.
  */
 #define PROC_INT_STOP()                                                     \
 do {                                                                        \
-    uint32_t __l_cpsr_tmp;                                                  \
-    __asm volatile("MRS %0, CPSR" : "=r"(__l_cpsr_tmp));                    \
-    __asm volatile("ORR %0, %1, #0x40" : "=r"(__l_cpsr_tmp) :               \
-                 "r"(__l_cpsr_tmp));                                        \
-    __asm volatile("MSR CPSR_cxsf, %0" : : "r"(__l_cpsr_tmp));              \
+    (void) proc_int_mask();                                                 \
 } while(0)
 
+#ifdef PROC_INT_DEBUG
+
+/// Interrupts disabled time allowed to a critical section (us)
+#ifndef PROC_INT_BUDGET_US
+#define PROC_INT_BUDGET_US (50)
+#endif
+
+/// Statistics of the critical sections
+struct proc_int_stats
+{
+    /// Longest time with the interrupts disabled (clock ticks)
+    uint32_t max;
+
+    /// Location of the critical section which disabled them for the longest time
+    char const *file;
+    uint16_t line;
+
+    /// Number of critical sections longer than @ref PROC_INT_BUDGET_US
+    uint32_t overruns;
+};
+
+/** @brief Disable interrupts, and start measuring if they were enabled.
+ * @param[in] file Source file of the critical section
+ * @param[in] line Source line of the critical section
+ * @return Previous state of the interrupts
+ */
+extern proc_int_state_t
+proc_int_disable_debug(char const *file, uint16_t line);
+
+/** @brief Restore interrupts, and account for the time they were disabled.
+ * @param[in] state State returned by @ref proc_int_disable_debug
+ */
+extern void
+proc_int_restore_debug(proc_int_state_t state);
+
+/** @brief Get the statistics of the critical sections.
+ * @param[out] stats Statistics
+ */
+extern void
+proc_int_stats_get(struct proc_int_stats *stats);
+
+/** @brief Reset the statistics of the critical sections.
+ */
+extern void
+proc_int_stats_reset(void);
+
+#define proc_int_disable() proc_int_disable_debug(__FILE__, __LINE__)
+#define proc_int_restore(__s) proc_int_restore_debug(__s)
+
+#else // PROC_INT_DEBUG
+
+/** @brief Disable interrupts (IRQ and FIQ) globally in the system.
+ * The critical sections can be nested and span functions: each call returns the state
+ * to restore, which must be passed to @ref proc_int_restore on every exit path.
+ *
+ * When PROC_INT_DEBUG is defined, the longest time spent with the interrupts disabled
+ * is measured with the clock, from the outermost disable to its restore.
+ * @return Previous state of the interrupts
+ */
+#define proc_int_disable() proc_int_mask()
+
+/** @brief Restore interrupts from the matching @ref proc_int_disable.
+ * @param[in] __s State returned by @ref proc_int_disable
+ */
+#define proc_int_restore(__s) proc_int_unmask(__s)
+
+#endif // PROC_INT_DEBUG
+
 /** @brief Disable interrupts globally in the system.
  * This macro must be used in conjunction with the @ref PROC_INT_RESTORE macro since this
  * last one will close the brace that the current macro opens.  This means that both
  * macros must be located at the same scope level.
+ * @sa proc_int_disable for critical sections spanning functions or returning early
  */
 #define PROC_INT_DISABLE()                                                  \
 do {                                                                        \
-    uint32_t __l_cpsr_tmp;                                                  \
-    uint32_t __l_irq_rest;                                                  \
-    __asm volatile("MRS %0, CPSR" : "=r"(__l_cpsr_tmp));                    \
-    __asm volatile("AND %0, %1, #0x40" : "=r"(__l_irq_rest) :               \
-                 "r"(__l_cpsr_tmp));                                        \
-    __asm volatile("ORR %0, %1, #0x40" : "=r"(__l_cpsr_tmp) :               \
-                 "r"(__l_cpsr_tmp));                                        \
-    __asm volatile("MSR CPSR_cxsf, %0" : : "r"(__l_cpsr_tmp));              \
+    proc_int_state_t __l_irq_rest = proc_int_disable();                     \
 
 /** @brief Restore interrupts from the previous global disable.
  * @sa PROC_INT_DISABLE
  */
 #define PROC_INT_RESTORE()                                                  \
-    __asm volatile("MRS %0, CPSR" : "=r"(__l_cpsr_tmp));                    \
-    __asm volatile("BIC %0, %1, #0x40" : "=r"(__l_cpsr_tmp) :               \
-                 "r"(__l_cpsr_tmp));                                        \
-    __asm volatile("ORR %0, %1, %2" : "=r"(__l_cpsr_tmp) :                  \
-                 "r"(__l_cpsr_tmp), "r"(__l_irq_rest));                     \
-    __asm volatile("MSR CPSR_cxsf, %0" : : "r"(__l_cpsr_tmp));              \
+    proc_int_restore(__l_irq_rest);                                         \
 } while(0)
 
 /** @brief Change the stack pointer in the running context.
@@ -122,11 +221,13 @@ do {                                                                        \
  * {
  *     __c += 1
  * }
+ * The variable is copied since the sequence shifts it in place.
  * @param[out] __c Result of the count
  * @param[in] __v Variable to count the leading zeros in
  */
 #define PROC_CLZ(__c, __v)                                                  \
 do {                                                                        \
+    uint32_t __l_clz_v = (__v);                                             \
     __asm volatile("lsrs    %0,%1,#16;"                                     \
                    "mov     %0,#0; "                                        \
                    "addeq   %0,%0,#16;"                                     \
@@ -141,7 +242,7 @@ do {                                                                        \
                    "addeq   %0,%0,#2;"                                      \
                    "lsleq   %1,%1,#2;"                                      \
                    "tst     %1,#0x80000000;"                                \
-                   "addeq    %0,%0,#1" : "=&r"(__c): "r"(__v)); \
+                   "addeq    %0,%0,#1" : "=&r"(__c), "+r"(__l_clz_v));  \
 } while(0)
 
 
@@ -26,12 +26,18 @@
 // processor related macros
 #include "proc/proc.h"
 
+// for the event selection
+#include "common/Bits.h"
+
 // timer related
 #include "common/Timer.h"
 
 // time related
 #include "common/Time.h"
 
+// for the boot time measurement
+#include "boot/Boot.h"
+
 /// RTOS environment
 struct rtos rtos_env;
 
@@ -65,20 +71,20 @@ struct rtos_msg
 // define event handlers
 static void schedule_timers(void);
 static void schedule_threads(void);
-extern void event_pb0(void);
-extern void event_pb1(void);
-extern void event_pb2(void);
-extern void event_pb3(void);
+extern void event_key(void);
+extern void event_adc(void);
+extern void event_adc_alert(void);
+extern void event_cmd(void);
 
 /// Main descriptor of the event handlers
 static void (* const events[])(void) =
 {
     [RTOS_E_TIMER_INDEX]   = schedule_timers,
     [RTOS_E_THREADS_INDEX] = schedule_threads,
-    [RTOS_E_PB0_INDEX]     = event_pb0,
-    [RTOS_E_PB1_INDEX]     = event_pb1,
-    [RTOS_E_PB2_INDEX]     = event_pb2,
-    [RTOS_E_PB3_INDEX]     = event_pb3
+    [RTOS_E_KEY_INDEX]     = event_key,
+    [RTOS_E_ADC_INDEX]     = event_adc,
+    [RTOS_E_ADC_ALERT_INDEX] = event_adc_alert,
+    [RTOS_E_CMD_INDEX]     = event_cmd
 };
 
 /// Definition of the stack for the various threads
@@ -122,10 +128,10 @@ static void schedule_timers(void)
         }
 
         // check if thread has expired or is about to
-        if (((int32_t)(timed->timeout.date - now)) > 32)
+        if (((int32_t)(timed->timeout.date - now)) > (int32_t)TimeMsToTicks(1))
         {
             // timer has not yet expired
-            TimerStart((timed->timeout.date - now) / 32);
+            TimerStart(TimeTicksToMs(timed->timeout.date - now));
 
             // timer was set so we exit the loop
             break;
@@ -190,19 +196,20 @@ void rtos_init(void* heap_bottom, void* heap_top)
     rtos_env.mfree->next = NULL;
 }
 
-void rtos_scheduler(uint32_t const *stack)
+__RAMFUNC void rtos_scheduler(uint32_t const *stack)
 {
     // reset the stack
     PROC_SP_RESET(stack);
 
+    // end of the boot
+    boot_time.dispatch = TimeGet();
+
     do
     {
         while (rtos_env.eventmask)
         {
-            uint32_t event;
-
             // return the next event to handle
-            PROC_CLZ(event, rtos_env.eventmask);
+            uint32_t event = BitsClz(rtos_env.eventmask);
 
             // call the appropriate event handler
             events[event]();
@@ -461,7 +468,7 @@ void *rtos_msg_wait(uint16_t id, uint16_t timeout)
         // get the current time
         uint32_t now = TimeGet();
         // compute the delay in number of RTC cycles
-        int32_t delay = timeout * 32;
+        int32_t delay = TimeMsToTicks(timeout);
         // compute the expiration date
         uint32_t expiration = now + delay;
 
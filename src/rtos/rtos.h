@@ -31,11 +31,11 @@ struct rtos_mem_free;
 enum
 {
     RTOS_E_TIMER_INDEX = 0,
-    RTOS_E_PB0_INDEX,
+    RTOS_E_KEY_INDEX,
     RTOS_E_THREADS_INDEX,
-    RTOS_E_PB1_INDEX,
-    RTOS_E_PB2_INDEX,
-    RTOS_E_PB3_INDEX
+    RTOS_E_ADC_INDEX,
+    RTOS_E_ADC_ALERT_INDEX,
+    RTOS_E_CMD_INDEX
 };
 
 /** Definition of the event bits for the raise operations the inversion (31-x) is used
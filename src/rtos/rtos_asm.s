@@ -20,7 +20,8 @@
 # *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
 # */
 
-.text
+# the context switch is on the hot path (see __RAMFUNC)
+.section .ramfunc, "ax"
     .align 4
 
 #/**
@@ -56,6 +57,9 @@ rtos_switch:
     bx lr
 
 
+.text
+    .align 4
+
 #/**
 # * Function to create a thread context on top of its stack
 # */
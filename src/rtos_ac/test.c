@@ -34,10 +34,6 @@
 //extern char heap_bottom;
 //extern char heap_top;
 
-__FIQ void FiqHandler(void)
-{
-}
-
 
 extern struct task_desc task_desc_tab[];
 
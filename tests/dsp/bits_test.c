@@ -0,0 +1,167 @@
+/*
+ * Host test and benchmark of the bit utilities
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// standard includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// tested module
+#include "Bits.h"
+
+/// Number of values of the benchmark (log2)
+#define BENCH_LOG2 (12)
+#define BENCH_SIZE (1 << BENCH_LOG2)
+
+/// Number of passes over the values of the benchmark
+#define BENCH_LOOPS (4096)
+
+/// Check a condition, the test stops at the first failure
+#define CHECK(__c) do {                                                     \
+    if (!(__c)) {                                                           \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #__c); \
+        exit(1);                                                            \
+    }                                                                       \
+} while (0)
+
+/// Measure a count of leading zeros over the bench_values, the result is kept so that
+/// the loop is not optimized out
+#define BENCH_CLZ(__name, __op)                                             \
+do {                                                                        \
+    uint32_t __l_sum = 0, __l_i, __l_n;                                     \
+    double __l_start = TestNow();                                           \
+    for (__l_n = 0; __l_n < BENCH_LOOPS; __l_n++)                           \
+    {                                                                       \
+        for (__l_i = 0; __l_i < BENCH_SIZE; __l_i++)                        \
+        {                                                                   \
+            __l_sum += __op(bench_values[__l_i]);                           \
+        }                                                                   \
+    }                                                                       \
+    printf("%s: %.2f ns/value, checksum %u\n", __name,                      \
+            (TestNow() - __l_start) * 1e9 / ((double) BENCH_LOOPS * BENCH_SIZE), \
+            __l_sum);                                                       \
+} while(0)
+
+/// Values of the benchmark, the leading zeros are evenly spread
+static volatile uint32_t bench_values[BENCH_SIZE];
+
+/**
+ * Get the time.
+ * @return The time in seconds
+ */
+static double
+TestNow(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Count the leading zeros bit by bit.
+ * @param[in] v Value
+ * @return Number of leading zeros
+ */
+static uint32_t
+RefClz(uint32_t v)
+{
+    uint32_t c = 0;
+
+    while ((c < 32) && !(v & (0x80000000UL >> c)))
+    {
+        c++;
+    }
+    return c;
+}
+
+/**
+ * Check the bit utilities against the bit by bit references for a value.
+ * @param[in] v Value
+ */
+static void
+TestValue(uint32_t v)
+{
+    uint32_t i, ffs = 0, pop = 0, rev = 0;
+
+    for (i = 32; i--; )
+    {
+        if (v & (1UL << i))
+        {
+            ffs = i + 1;
+            pop++;
+            rev |= 1UL << (31 - i);
+        }
+    }
+
+    if (v)
+    {
+        CHECK(BitsClzTable(v) == RefClz(v));
+        CHECK(BitsClzC(v) == RefClz(v));
+        CHECK(BitsClz(v) == (uint32_t) __builtin_clz(v));
+    }
+    CHECK(BitsFfs(v) == ffs);
+    CHECK(BitsPopcount(v) == pop);
+    CHECK(BitsRev32(v) == rev);
+    for (i = 1; i <= 32; i++)
+    {
+        if ((i == 32) || (v < (1UL << i)))
+        {
+            CHECK(BitsRev(v, i) == (rev >> (32 - i)));
+        }
+    }
+}
+
+int
+main(void)
+{
+    uint32_t i, j, seed = 1;
+
+    // every single bit and every mask of the low bits
+    TestValue(0);
+    for (i = 0; i < 32; i++)
+    {
+        TestValue(1UL << i);
+        TestValue((1UL << i) - 1);
+        TestValue(~((1UL << i) - 1));
+        for (j = 0; j < 32; j++)
+        {
+            TestValue((1UL << i) | (1UL << j));
+        }
+    }
+
+    // random values with an evenly spread number of leading zeros
+    for (i = 0; i < (1UL << 20); i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        TestValue((seed | 0x80000000UL) >> (i & 31));
+    }
+    printf("bits: ok\n");
+
+    for (i = 0; i < BENCH_SIZE; i++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        bench_values[i] = (seed | 0x80000000UL) >> ((seed >> 8) & 31);
+    }
+    BENCH_CLZ("clz table", BitsClzTable);
+    BENCH_CLZ("clz C", BitsClzC);
+    BENCH_CLZ("clz builtin", __builtin_clz);
+
+    return 0;
+}
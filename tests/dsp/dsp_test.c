@@ -0,0 +1,221 @@
+/*
+ * Host test of the DSP blocks against the golden vectors of gen_golden.py
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// standard includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+// tested module
+#include "Dsp.h"
+
+// reference inputs and outputs
+#include "golden.h"
+
+// tolerances, in Q15 LSB, between the fixed point results and the double precision
+// references:
+// + references: printed with 3 decimals
+#define TOL_REF     (0.001)
+// + FIR: the accumulation is exact, only the final rounding to Q15
+#define TOL_FIR     (0.5 + TOL_REF)
+// + biquad: the rounding of the outputs is fed back by the poles and goes through the
+//   second section (noise gain of the cascade)
+#define TOL_BIQUAD  (4.0)
+// + RMS: the squares are truncated to Q22 and the square root is rounded down
+#define TOL_RMS     (1.5)
+// + mean: the sum is shifted, i.e. rounded down
+#define TOL_MEAN    (1.0)
+// + FFT: each stage truncates the products and the halving, up to 1 LSB, and the
+//   butterflies average the errors of their inputs, so the errors add up over the stages
+#define TOL_FFT     (GOLDEN_FFT_LOG2 * 1.0)
+
+/// Check a condition, the test stops at the first failure
+#define CHECK(__c) do {                                                     \
+    if (!(__c)) {                                                           \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #__c); \
+        exit(1);                                                            \
+    }                                                                       \
+} while (0)
+
+static q15_t test_out[GOLDEN_SIZE];
+static q15_t test_state[2 * 16];
+static q15_t test_window[1 << GOLDEN_RMS_LOG2];
+static struct dsp_complex test_fft[1 << GOLDEN_FFT_LOG2];
+
+/**
+ * Compare the output samples of a block with the references, the worst error is
+ * printed.
+ * @param[in] name Name of the block
+ * @param[in] out Output samples
+ * @param[in] ref Reference samples
+ * @param[in] n Number of samples
+ * @param[in] tol Tolerance (LSB)
+ */
+static void
+TestCompare(char const *name, q15_t const *out, double const *ref, uint32_t n,
+        double tol)
+{
+    double err, max = 0;
+    uint32_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        err = fabs(out[i] - ref[i]);
+        if (err > tol)
+        {
+            fprintf(stderr, "%s: sample %u = %d, expected %.3f (tolerance %.3f)\n",
+                    name, i, out[i], ref[i], tol);
+            exit(1);
+        }
+        if (err > max)
+        {
+            max = err;
+        }
+    }
+
+    printf("%s: ok, %u samples, max error %.3f LSB (tolerance %.3f)\n", name, n, max,
+            tol);
+}
+
+/**
+ * Filter the input with the FIR, with and without decimation.
+ */
+static void
+TestFir(void)
+{
+    struct dsp_fir fir;
+    uint32_t n;
+
+    DspFirInit(&fir, golden_fir_coefs, test_state, 16);
+    n = DspFir(&fir, golden_in, test_out, GOLDEN_SIZE, 1);
+    CHECK(n == GOLDEN_SIZE);
+    TestCompare("fir", test_out, golden_fir, n, TOL_FIR);
+
+    // the state carries over between two buffers
+    DspFirInit(&fir, golden_fir_coefs, test_state, 16);
+    n = DspFir(&fir, golden_in, test_out, GOLDEN_SIZE / 2, GOLDEN_DECIM);
+    n += DspFir(&fir, &golden_in[GOLDEN_SIZE / 2], &test_out[n], GOLDEN_SIZE / 2,
+            GOLDEN_DECIM);
+    CHECK(n == GOLDEN_SIZE / GOLDEN_DECIM);
+    TestCompare("fir decimated", test_out, golden_fir_decim, n, TOL_FIR);
+}
+
+/**
+ * Filter the input with the biquad cascade, in place.
+ */
+static void
+TestBiquad(void)
+{
+    struct dsp_biquad bq[GOLDEN_STAGES];
+    uint32_t i;
+
+    for (i = 0; i < GOLDEN_STAGES; i++)
+    {
+        DspBiquadInit(&bq[i], GOLDEN_BIQUAD);
+    }
+    for (i = 0; i < GOLDEN_SIZE; i++)
+    {
+        test_out[i] = golden_in[i];
+    }
+    DspBiquad(bq, GOLDEN_STAGES, test_out, test_out, GOLDEN_SIZE);
+    TestCompare("biquad", test_out, golden_biquad, GOLDEN_SIZE, TOL_BIQUAD);
+}
+
+/**
+ * Follow the RMS of the input, and compute the statistics of the whole input.
+ */
+static void
+TestRmsStats(void)
+{
+    struct dsp_rms rms;
+    struct dsp_stats stats;
+    uint32_t i;
+
+    DspRmsInit(&rms, test_window, GOLDEN_RMS_LOG2);
+    for (i = 0; i < GOLDEN_SIZE; i++)
+    {
+        test_out[i] = DspRms(&rms, golden_in[i]);
+    }
+    TestCompare("rms", test_out, golden_rms, GOLDEN_SIZE, TOL_RMS);
+
+    DspStats(golden_in, GOLDEN_LOG2, &stats);
+    CHECK(stats.min == golden_min);
+    CHECK(stats.max == golden_max);
+    CHECK(fabs(stats.mean - golden_mean) <= TOL_MEAN);
+    printf("stats: ok, min %d, max %d, mean %d (expected %.3f, tolerance %.1f)\n",
+            stats.min, stats.max, stats.mean, golden_mean, TOL_MEAN);
+}
+
+/**
+ * Transform the complex input.
+ */
+static void
+TestFft(void)
+{
+    double re[1 << GOLDEN_FFT_LOG2], im[1 << GOLDEN_FFT_LOG2];
+    q15_t out_re[1 << GOLDEN_FFT_LOG2], out_im[1 << GOLDEN_FFT_LOG2];
+    uint32_t i;
+
+    for (i = 0; i < (1 << GOLDEN_FFT_LOG2); i++)
+    {
+        test_fft[i] = golden_fft_in[i];
+    }
+    DspFft(test_fft, GOLDEN_FFT_LOG2);
+
+    for (i = 0; i < (1 << GOLDEN_FFT_LOG2); i++)
+    {
+        out_re[i] = test_fft[i].re;
+        out_im[i] = test_fft[i].im;
+        re[i] = golden_fft[i].re;
+        im[i] = golden_fft[i].im;
+    }
+    TestCompare("fft real", out_re, re, 1 << GOLDEN_FFT_LOG2, TOL_FFT);
+    TestCompare("fft imaginary", out_im, im, 1 << GOLDEN_FFT_LOG2, TOL_FFT);
+}
+
+/**
+ * Compare the integer square root with the rounded down square root.
+ */
+static void
+TestSqrt(void)
+{
+    uint64_t x;
+    uint32_t r;
+
+    for (x = 1; x <= 0xFFFFFFFF; x += (x >> 4) + 1)
+    {
+        r = DspSqrt(x);
+        CHECK(((uint64_t) r * r <= x) && ((uint64_t) (r + 1) * (r + 1) > x));
+    }
+    CHECK(DspSqrt(0) == 0);
+    CHECK(DspSqrt(0xFFFFFFFF) == 0xFFFF);
+    printf("sqrt: ok\n");
+}
+
+int
+main(void)
+{
+    TestFir();
+    TestBiquad();
+    TestRmsStats();
+    TestFft();
+    TestSqrt();
+
+    return 0;
+}
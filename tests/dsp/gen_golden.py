@@ -0,0 +1,186 @@
+# Generate the golden vectors of the DSP host test.
+#
+#    Copyright (C) 2009 Louis Caron
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+"""
+Usage: gen_golden.py [-o golden.h]
+
+The input samples and the expected outputs of the DSP blocks are computed in double
+precision from the quantized coefficients, so that the difference with the fixed
+point results only comes from the arithmetic of Dsp.c.  The output is checked in,
+run this script again only when the vectors change.
+"""
+
+from __future__ import print_function
+
+import getopt
+import math
+import sys
+
+# number of samples of the time domain blocks (log2), as in the DSP benchmark
+LOG2 = 8
+SIZE = 1 << LOG2
+
+# 16 taps low pass FIR, cut-off at 0.1 of the sampling rate (Q15)
+FIR = [-114, -159, -139, 291, 1450, 3284, 5246, 6524,
+       6524, 5246, 3284, 1450, 291, -139, -159, -114]
+
+# decimation factor of the decimating FIR
+DECIM = 4
+
+# low pass biquad, cut-off at 0.1 of the sampling rate, Q = 0.707 (Q14), 2 sections
+BIQUAD = [1105, 2210, 1105, -18727, 6763]
+STAGES = 2
+
+# window of the moving RMS (log2)
+RMS_LOG2 = 6
+
+# number of points of the FFT (log2)
+FFT_LOG2 = 6
+
+
+def lcg(seed):
+    """Same generator as the DSP benchmark, returns the signed 32 bits values"""
+    while True:
+        seed = (seed * 1664525 + 1013904223) & 0xFFFFFFFF
+        yield seed - (1 << 32) if seed & 0x80000000 else seed
+
+
+def gen_input():
+    """Square wave plus noise, as in the DSP benchmark"""
+    rnd = lcg(1)
+    return [(8192 if i & 16 else -8192) + (next(rnd) >> 19) for i in range(SIZE)]
+
+
+def gen_fft_input():
+    """Two tones plus noise, each component below 0.5 so that the magnitude is below 1"""
+    rnd = lcg(7)
+    n = 1 << FFT_LOG2
+    out = []
+    for i in range(n):
+        re = 6000 * math.cos(2 * math.pi * 3 * i / n) + \
+             3000 * math.cos(2 * math.pi * 11 * i / n + 0.5)
+        im = 6000 * math.sin(2 * math.pi * 3 * i / n) - \
+             2000 * math.sin(2 * math.pi * 20 * i / n)
+        out.append((int(round(re)) + (next(rnd) >> 22),
+                    int(round(im)) + (next(rnd) >> 22)))
+    return out
+
+
+def fir(x, coefs, decim):
+    """FIR filter with a null history, the first output is the first input sample"""
+    out = []
+    for i in range(0, len(x), decim):
+        acc = 0.0
+        for k, c in enumerate(coefs):
+            if i - k >= 0:
+                acc += c * x[i - k]
+        out.append(acc / 32768.0)
+    return out
+
+
+def biquad(x, coefs, stages):
+    """Cascade of identical direct form I sections with a null history"""
+    b0, b1, b2, a1, a2 = [c / 16384.0 for c in coefs]
+    for _ in range(stages):
+        x1 = x2 = y1 = y2 = 0.0
+        out = []
+        for v in x:
+            y = b0 * v + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2
+            x2, x1, y2, y1 = x1, v, y1, y
+            out.append(y)
+        x = out
+    return x
+
+
+def rms(x, log2):
+    """Moving RMS over a window of null samples"""
+    n = 1 << log2
+    window = [0] * n + list(x)
+    return [math.sqrt(sum(v * v for v in window[i + 1:i + 1 + n]) / float(n))
+            for i in range(len(x))]
+
+
+def fft(x):
+    """DFT divided by the number of points"""
+    n = len(x)
+    out = []
+    for k in range(n):
+        re = im = 0.0
+        for i, (xr, xi) in enumerate(x):
+            a = -2 * math.pi * k * i / n
+            re += xr * math.cos(a) - xi * math.sin(a)
+            im += xr * math.sin(a) + xi * math.cos(a)
+        out.append((re / n, im / n))
+    return out
+
+
+def c_array(f, ctype, name, values, fmt, per_line):
+    f.write('static %s const %s[%d] =\n{\n' % (ctype, name, len(values)))
+    for i in range(0, len(values), per_line):
+        f.write('    ' + ', '.join(fmt(v) for v in values[i:i + per_line]) + ',\n')
+    f.write('};\n\n')
+
+
+def main():
+    output = 'golden.h'
+    try:
+        opts, args = getopt.getopt(sys.argv[1:], 'ho:')
+    except getopt.GetoptError as err:
+        print(err)
+        print(__doc__)
+        sys.exit(2)
+    for o, a in opts:
+        if o == '-h':
+            print(__doc__)
+            sys.exit(0)
+        elif o == '-o':
+            output = a
+
+    x = gen_input()
+    fx = gen_fft_input()
+    ref = lambda v: '%.3f' % v
+    cplx = lambda v: '{%d, %d}' % v
+    cref = lambda v: '{%.3f, %.3f}' % v
+
+    f = open(output, 'w')
+    f.write('/*\n * Golden vectors of the DSP host test, generated by gen_golden.py\n'
+            ' * (do not edit)\n */\n\n')
+    f.write('#define GOLDEN_LOG2     (%d)\n' % LOG2)
+    f.write('#define GOLDEN_SIZE     (1 << GOLDEN_LOG2)\n')
+    f.write('#define GOLDEN_DECIM    (%d)\n' % DECIM)
+    f.write('#define GOLDEN_STAGES   (%d)\n' % STAGES)
+    f.write('#define GOLDEN_RMS_LOG2 (%d)\n' % RMS_LOG2)
+    f.write('#define GOLDEN_FFT_LOG2 (%d)\n' % FFT_LOG2)
+    f.write('#define GOLDEN_BIQUAD   %s\n\n' % ', '.join(str(c) for c in BIQUAD))
+    f.write('/// Complex reference sample\nstruct golden_complex\n{\n'
+            '    double re;\n    double im;\n};\n\n')
+
+    c_array(f, 'q15_t', 'golden_fir_coefs', FIR, str, 8)
+    c_array(f, 'q15_t', 'golden_in', x, str, 8)
+    c_array(f, 'double', 'golden_fir', fir(x, FIR, 1), ref, 6)
+    c_array(f, 'double', 'golden_fir_decim', fir(x, FIR, DECIM), ref, 6)
+    c_array(f, 'double', 'golden_biquad', biquad(x, BIQUAD, STAGES), ref, 6)
+    c_array(f, 'double', 'golden_rms', rms(x, RMS_LOG2), ref, 6)
+    f.write('static q15_t const golden_min = %d;\n' % min(x))
+    f.write('static q15_t const golden_max = %d;\n' % max(x))
+    f.write('static double const golden_mean = %.3f;\n\n' % (sum(x) / float(SIZE)))
+    c_array(f, 'struct dsp_complex', 'golden_fft_in', fx, cplx, 4)
+    c_array(f, 'struct golden_complex', 'golden_fft', fft(fx), cref, 3)
+    f.close()
+
+
+if __name__ == '__main__':
+    main()
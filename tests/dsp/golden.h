@@ -0,0 +1,268 @@
+/*
+ * Golden vectors of the DSP host test, generated by gen_golden.py
+ * (do not edit)
+ */
+
+#define GOLDEN_LOG2     (8)
+#define GOLDEN_SIZE     (1 << GOLDEN_LOG2)
+#define GOLDEN_DECIM    (4)
+#define GOLDEN_STAGES   (2)
+#define GOLDEN_RMS_LOG2 (6)
+#define GOLDEN_FFT_LOG2 (6)
+#define GOLDEN_BIQUAD   1105, 2210, 1105, -18727, 6763
+
+/// Complex reference sample
+struct golden_complex
+{
+    double re;
+    double im;
+};
+
+static q15_t const golden_fir_coefs[16] =
+{
+    -114, -159, -139, 291, 1450, 3284, 5246, 6524,
+    6524, 5246, 3284, 1450, 291, -139, -159, -114,
+};
+
+static q15_t const golden_in[256] =
+{
+    -6255, -5167, -12254, -10610, -7778, -5165, -10038, -11828,
+    -8057, -11148, -6141, -4732, -11546, -9528, -6267, -8349,
+    7052, 10869, 5591, 4353, 9960, 9048, 8769, 10804,
+    9255, 5793, 4775, 11299, 10346, 6151, 7624, 9644,
+    -5455, -8330, -5009, -11895, -4374, -8239, -9216, -10557,
+    -8539, -8397, -6923, -5143, -10763, -6853, -4160, -6768,
+    4850, 7142, 10900, 8349, 7791, 10083, 6811, 8404,
+    11336, 8574, 11022, 9266, 6632, 11533, 9398, 5005,
+    -9878, -8739, -8101, -7941, -8213, -9800, -4462, -4986,
+    -10882, -8477, -10375, -4192, -4787, -6996, -8995, -10265,
+    5212, 4736, 4415, 8620, 11644, 4614, 7752, 10947,
+    6366, 10438, 7463, 7710, 11731, 11728, 11087, 8363,
+    -10958, -10249, -4572, -4099, -9498, -5879, -8179, -5316,
+    -10970, -7530, -5778, -6431, -6188, -10054, -12276, -11344,
+    4734, 8053, 12117, 10631, 8085, 5892, 5141, 11883,
+    4926, 9161, 7694, 6753, 8271, 9778, 4606, 8337,
+    -11780, -4300, -4474, -4568, -8033, -10811, -8578, -10352,
+    -12237, -9764, -5329, -11164, -8466, -5753, -9992, -11596,
+    4750, 9334, 8403, 4615, 6848, 8862, 8526, 7860,
+    10044, 10840, 10593, 11764, 6146, 10899, 10162, 9030,
+    -10689, -10874, -12097, -4204, -5028, -8084, -10638, -7511,
+    -9287, -11064, -11366, -4252, -10622, -6220, -10802, -5316,
+    11328, 5045, 6198, 6534, 8065, 6547, 10689, 6920,
+    9006, 5316, 8508, 8783, 9744, 6100, 10710, 5459,
+    -9490, -4771, -9589, -4901, -11294, -7681, -11529, -5583,
+    -4275, -7191, -8180, -7271, -8972, -5022, -11460, -12271,
+    10698, 12257, 7803, 8924, 10461, 6437, 12218, 12111,
+    6122, 7134, 11836, 5484, 9759, 4951, 9304, 8131,
+    -5248, -5717, -6103, -7401, -6283, -5119, -8807, -10158,
+    -6908, -10159, -11166, -11972, -5335, -9934, -5010, -12163,
+    10209, 11308, 4896, 5474, 11353, 5910, 5128, 5106,
+    6338, 6392, 8063, 6596, 7762, 11004, 4518, 10269,
+};
+
+static double const golden_fir[256] =
+{
+    21.761, 48.327, 94.237, 62.742, -192.150, -863.622,
+    -2062.722, -3727.459, -5561.265, -7137.623, -8208.679, -8751.712,
+    -8946.584, -9036.688, -9089.789, -9035.545, -8908.801, -8709.012,
+    -8529.885, -8256.818, -7527.752, -5909.229, -3341.236, -198.246,
+    2898.416, 5363.203, 7015.778, 7985.535, 8520.768, 8790.858,
+    8808.280, 8583.954, 8359.043, 8254.290, 8286.140, 8272.360,
+    7756.544, 6356.351, 3950.102, 864.227, -2304.427, -4959.574,
+    -6793.448, -7828.303, -8328.008, -8594.479, -8703.949, -8610.141,
+    -8412.614, -8124.413, -7801.083, -7376.730, -6533.813, -4985.515,
+    -2583.770, 412.582, 3479.883, 6043.659, 7730.439, 8564.382,
+    8815.161, 8867.278, 8987.620, 9186.490, 9453.574, 9637.039,
+    9661.154, 9286.426, 8173.882, 6069.281, 2977.598, -616.542,
+    -3979.077, -6490.018, -7806.708, -8133.018, -7940.759, -7692.108,
+    -7631.348, -7694.462, -7788.155, -7716.695, -7516.323, -7229.949,
+    -6748.894, -5800.126, -4123.684, -1683.028, 1200.082, 3950.528,
+    6072.350, 7393.401, 8029.467, 8274.785, 8358.255, 8414.117,
+    8649.451, 9038.520, 9507.606, 9736.062, 9180.726, 7339.479,
+    4296.981, 635.184, -2770.917, -5224.302, -6546.096, -7032.804,
+    -7174.099, -7298.996, -7440.276, -7472.977, -7465.322, -7483.151,
+    -7701.834, -8058.230, -8142.643, -7285.327, -5049.860, -1566.132,
+    2399.892, 5794.277, 7902.560, 8632.761, 8459.278, 8008.813,
+    7711.968, 7622.557, 7765.309, 7907.475, 7975.290, 7733.262,
+    6881.547, 5210.199, 2795.251, 76.827, -2493.218, -4554.923,
+    -6087.721, -7250.132, -8250.844, -9101.435, -9674.222, -9822.578,
+    -9706.588, -9390.712, -9078.524, -8746.386, -8120.517, -6775.934,
+    -4465.102, -1405.266, 1803.918, 4518.282, 6364.175, 7341.873,
+    7851.717, 8267.409, 8777.292, 9309.541, 9824.787, 10161.500,
+    10276.189, 9946.772, 8853.436, 6666.867, 3398.347, -439.034,
+    -3969.575, -6466.988, -7704.705, -8033.007, -8056.843, -8251.987,
+    -8661.928, -9071.835, -9347.276, -9330.401, -9108.245, -8552.858,
+    -7435.565, -5531.164, -2892.038, 156.558, 3020.157, 5238.654,
+    6627.580, 7382.703, 7734.772, 7927.493, 7969.485, 7945.019,
+    8005.322, 8118.493, 8298.203, 8229.366, 7527.652, 5830.651,
+    3206.194, 5.317, -3136.017, -5706.026, -7423.010, -8292.708,
+    -8472.338, -8235.370, -7752.579, -7277.530, -7097.310, -7207.296,
+    -7588.691, -7898.882, -7614.873, -6178.792, -3504.138, 75.073,
+    3782.627, 6791.404, 8676.405, 9544.247, 9730.846, 9676.845,
+    9495.460, 9206.870, 8921.641, 8622.300, 8353.035, 8021.568,
+    7334.946, 5958.252, 3820.814, 1123.717, -1680.272, -4039.449,
+    -5656.209, -6605.998, -7162.926, -7646.652, -8221.571, -8806.473,
+    -9375.280, -9693.775, -9669.792, -9194.169, -8038.677, -5983.426,
+    -3122.836, 167.968, 3306.681, 5697.821, 7021.267, 7352.196,
+    7082.257, 6617.174, 6320.647, 6219.443,
+};
+
+static double const golden_fir_decim[64] =
+{
+    21.761, -192.150, -5561.265, -8946.584, -8908.801, -7527.752,
+    2898.416, 8520.768, 8359.043, 7756.544, -2304.427, -8328.008,
+    -8412.614, -6533.813, 3479.883, 8815.161, 9453.574, 8173.882,
+    -3979.077, -7940.759, -7788.155, -6748.894, 1200.082, 8029.467,
+    8649.451, 9180.726, -2770.917, -7174.099, -7465.322, -8142.643,
+    2399.892, 8459.278, 7765.309, 6881.547, -2493.218, -8250.844,
+    -9706.588, -8120.517, 1803.918, 7851.717, 9824.787, 8853.436,
+    -3969.575, -8056.843, -9347.276, -7435.565, 3020.157, 7734.772,
+    8005.322, 7527.652, -3136.017, -8472.338, -7097.310, -7614.873,
+    3782.627, 9730.846, 8921.641, 7334.946, -1680.272, -7162.926,
+    -9375.280, -8038.677, 3306.681, 7082.257,
+};
+
+static double const golden_biquad[256] =
+{
+    -28.452, -202.352, -722.382, -1772.847, -3384.033, -5304.405,
+    -7061.598, -8292.135, -8984.340, -9345.189, -9541.336, -9590.279,
+    -9414.331, -9030.672, -8627.517, -8362.134, -8156.059, -7626.447,
+    -6230.659, -3746.522, -580.535, 2572.978, 5226.875, 7210.252,
+    8553.659, 9365.430, 9702.201, 9568.814, 9099.536, 8597.980,
+    8287.113, 8159.540, 8064.975, 7687.954, 6554.452, 4384.677,
+    1380.117, -1889.009, -4790.474, -6942.704, -8327.609, -9120.370,
+    -9480.974, -9485.840, -9181.427, -8688.783, -8185.656, -7748.062,
+    -7282.925, -6544.338, -5179.734, -2951.719, -1.968, 3162.293,
+    5959.049, 7998.518, 9173.465, 9646.292, 9725.121, 9680.214,
+    9641.430, 9600.751, 9521.400, 9416.802, 9186.388, 8412.660,
+    6577.775, 3585.861, -60.406, -3607.595, -6459.380, -8299.605,
+    -9073.013, -9024.968, -8627.823, -8289.060, -8109.321, -7929.839,
+    -7612.413, -7242.686, -6985.672, -6719.097, -5982.792, -4412.287,
+    -2040.920, 810.871, 3674.736, 6065.470, 7720.628, 8671.220,
+    9091.366, 9168.939, 9060.336, 8925.448, 8947.983, 9221.534,
+    9553.344, 9338.563, 7853.368, 4943.471, 1262.674, -2274.908,
+    -5064.638, -6903.384, -7865.097, -8207.495, -8241.690, -8151.112,
+    -7956.463, -7661.995, -7390.265, -7368.907, -7694.503, -8003.066,
+    -7515.885, -5600.661, -2290.988, 1696.133, 5357.318, 7927.009,
+    9213.070, 9502.839, 9224.100, 8733.514, 8255.763, 7898.528,
+    7706.557, 7649.451, 7542.052, 6980.587, 5535.502, 3188.965,
+    416.569, -2233.622, -4486.648, -6309.823, -7748.725, -8868.936,
+    -9706.872, -10201.939, -10295.488, -10059.544, -9627.388, -9134.266,
+    -8698.655, -8176.906, -7044.406, -4859.802, -1788.592, 1504.670,
+    4376.591, 6515.573, 7902.051, 8688.299, 9118.034, 9427.234,
+    9736.970, 10007.838, 10135.210, 10102.743, 9890.307, 9165.626,
+    7338.527, 4156.541, 143.697, -3682.822, -6517.748, -8179.364,
+    -8940.994, -9178.012, -9217.823, -9278.799, -9375.386, -9378.662,
+    -9217.517, -8944.722, -8549.716, -7715.084, -5995.161, -3337.779,
+    -203.682, 2798.562, 5238.631, 6966.588, 8046.706, 8609.540,
+    8762.704, 8617.094, 8343.584, 8127.115, 8052.318, 8088.842,
+    8074.492, 7603.585, 6186.278, 3697.093, 529.195, -2700.955,
+    -5501.301, -7620.691, -8957.732, -9468.488, -9239.408, -8569.927,
+    -7847.331, -7339.056, -7116.822, -7164.497, -7412.646, -7451.469,
+    -6503.080, -4097.479, -575.920, 3213.452, 6471.496, 8781.467,
+    10153.920, 10774.746, 10793.162, 10387.954, 9797.727, 9196.680,
+    8650.364, 8186.553, 7793.011, 7248.877, 6122.475, 4140.798,
+    1467.319, -1408.430, -3950.988, -5844.281, -7093.854, -7877.399,
+    -8374.193, -8753.590, -9144.503, -9519.798, -9717.040, -9623.397,
+    -9223.820, -8346.705, -6577.889, -3752.818, -322.229, 3002.976,
+    5693.962, 7458.704, 8220.454, 8155.123, 7626.693, 7023.618,
+    6610.967, 6492.481, 6664.583, 7035.164,
+};
+
+static double const golden_rms[256] =
+{
+    781.875, 1014.142, 1837.047, 2265.763, 2465.553, 2548.682,
+    2840.806, 3202.521, 3357.148, 3634.871, 3715.041, 3761.835,
+    4029.190, 4201.530, 4273.936, 4399.510, 4486.951, 4688.133,
+    4739.938, 4771.068, 4930.833, 5058.881, 5176.269, 5349.543,
+    5473.205, 5520.900, 5553.070, 5729.869, 5874.001, 5924.108,
+    6000.272, 6120.171, 6158.040, 6245.451, 6276.758, 6450.464,
+    6473.594, 6555.003, 6655.461, 6785.026, 6868.469, 6948.207,
+    7001.889, 7031.340, 7158.895, 7209.964, 7228.691, 7278.028,
+    7303.235, 7357.597, 7482.690, 7555.117, 7617.626, 7721.190,
+    7767.986, 7838.697, 7965.742, 8037.518, 8154.747, 8236.591,
+    8278.205, 8402.795, 8484.515, 8507.550, 8561.056, 8606.266,
+    8529.183, 8483.710, 8490.113, 8553.702, 8479.534, 8372.872,
+    8422.646, 8373.883, 8438.872, 8434.409, 8331.527, 8292.202,
+    8331.336, 8364.712, 8343.610, 8253.510, 8242.364, 8294.667,
+    8328.863, 8271.846, 8255.962, 8258.905, 8216.104, 8287.483,
+    8318.436, 8254.113, 8283.003, 8376.523, 8436.739, 8415.352,
+    8498.789, 8531.500, 8527.665, 8412.657, 8478.410, 8447.652,
+    8430.953, 8353.510, 8397.748, 8384.891, 8371.330, 8385.231,
+    8312.663, 8363.371, 8487.065, 8563.018, 8562.004, 8574.625,
+    8600.110, 8639.366, 8643.585, 8582.858, 8564.671, 8628.811,
+    8533.911, 8543.436, 8486.287, 8449.146, 8471.701, 8437.140,
+    8374.771, 8416.140, 8454.292, 8400.635, 8358.111, 8318.579,
+    8315.833, 8335.386, 8385.541, 8461.873, 8490.746, 8512.319,
+    8439.278, 8537.814, 8582.313, 8567.876, 8585.119, 8611.557,
+    8607.381, 8665.901, 8711.863, 8664.199, 8583.857, 8635.802,
+    8647.192, 8594.579, 8649.269, 8656.991, 8707.844, 8778.389,
+    8689.077, 8672.195, 8654.470, 8664.936, 8659.685, 8671.587,
+    8783.868, 8784.643, 8726.706, 8754.226, 8795.422, 8820.396,
+    8790.147, 8848.357, 8932.542, 8912.159, 8977.260, 8922.796,
+    8892.962, 8804.295, 8897.780, 8863.120, 8767.043, 8704.149,
+    8703.859, 8711.169, 8789.581, 8706.240, 8757.099, 8707.298,
+    8719.123, 8747.336, 8771.004, 8718.831, 8802.203, 8766.892,
+    8723.378, 8727.204, 8791.361, 8794.163, 8849.976, 8798.732,
+    8851.261, 8783.929, 8666.211, 8626.794, 8661.602, 8596.626,
+    8604.641, 8597.487, 8626.056, 8640.634, 8723.317, 8779.656,
+    8770.999, 8822.810, 8878.014, 8845.306, 8912.694, 8986.803,
+    8931.515, 8873.057, 8897.570, 8801.949, 8852.807, 8769.215,
+    8754.322, 8740.544, 8662.691, 8585.181, 8485.328, 8519.419,
+    8532.426, 8496.507, 8463.706, 8506.768, 8471.310, 8453.579,
+    8449.413, 8564.438, 8487.132, 8542.180, 8458.005, 8567.837,
+    8545.834, 8638.956, 8625.884, 8614.348, 8672.058, 8664.907,
+    8585.235, 8565.360, 8527.939, 8539.472, 8532.723, 8501.872,
+    8469.929, 8546.946, 8460.318, 8529.891,
+};
+
+static q15_t const golden_min = -12276;
+static q15_t const golden_max = 12257;
+static double const golden_mean = 42.160;
+
+static struct dsp_complex const golden_fft_in[64] =
+{
+    {8877, -89}, {5317, -181}, {2380, 4600}, {1696, 5457},
+    {2687, 3526}, {3342, 6256}, {1593, 6835}, {-3845, 3216},
+    {-7347, 4671}, {-6908, 4524}, {-4617, 249}, {-2930, -1610},
+    {-3831, 70}, {-5628, -4591}, {-6198, -5938}, {-2919, -3784},
+    {1554, -6388}, {4509, -7503}, {4319, -3651}, {3221, -3461},
+    {2922, -3976}, {4348, -119}, {8126, 2746}, {8099, 597},
+    {5475, 4239}, {1184, 7321}, {-1433, 4388}, {-1568, 5710},
+    {219, 7987}, {-863, 3875}, {-5038, 1673}, {-8103, 3121},
+    {-8898, -120}, {-5334, -3173}, {-2701, -2095}, {-1836, -3380},
+    {-2837, -7587}, {-3038, -5324}, {-919, -4187}, {3388, -7431},
+    {7334, -4190}, {7693, -1160}, {4742, -2370}, {2521, -427},
+    {4088, 4633}, {6171, 3251}, {6189, 3784}, {3057, 7281},
+    {-988, 6275}, {-5230, 4238}, {-4621, 6798}, {-2472, 4316},
+    {-2703, 64}, {-4611, 1031}, {-8234, 321}, {-8492, -4858},
+    {-5535, -4395}, {-630, -3704}, {2138, -7305}, {1054, -6535},
+    {248, -3699}, {852, -5419}, {4673, -4718}, {8131, 350},
+};
+
+static struct golden_complex const golden_fft[64] =
+{
+    {28.750, 0.547}, {-0.291, -49.896}, {-1.379, -24.188},
+    {6020.606, -21.968}, {-68.147, 39.778}, {-9.534, 43.377},
+    {-7.034, -11.305}, {-38.467, 14.963}, {25.662, -22.436},
+    {-52.317, -18.321}, {67.687, -24.094}, {1282.969, 704.589},
+    {22.120, 34.311}, {12.628, 39.931}, {-23.968, -8.845},
+    {-83.712, 5.142}, {25.406, -35.641}, {-11.554, 50.993},
+    {-61.766, 7.870}, {58.168, 6.254}, {-914.296, 52.168},
+    {-5.398, -17.610}, {1.287, 15.400}, {45.141, -18.224},
+    {30.156, -18.078}, {-61.377, 18.288}, {-10.879, 33.891},
+    {6.052, -48.433}, {-8.968, -58.013}, {57.174, 31.729},
+    {-27.960, -71.790}, {12.485, 6.272}, {23.250, 66.672},
+    {23.413, 5.316}, {24.630, -48.601}, {87.491, -25.340},
+    {-18.158, -33.142}, {-12.800, 44.790}, {-62.951, 44.463},
+    {52.667, -19.256}, {-32.630, -9.752}, {59.784, 23.834},
+    {-22.001, -4.765}, {18.228, -14.981}, {1057.582, -58.713},
+    {-2.995, -23.033}, {-15.272, 30.985}, {6.790, -53.484},
+    {1.656, 32.234}, {-9.040, -35.644}, {46.370, 56.644},
+    {81.793, -1.596}, {-21.024, -58.304}, {1316.802, -788.420},
+    {10.981, -1.106}, {-13.696, 77.753}, {-43.250, -13.172},
+    {-34.050, 36.092}, {-36.410, -14.632}, {66.582, 27.509},
+    {28.142, 1.040}, {7.553, 10.823}, {-28.082, -3.926},
+    {6.403, 4.049},
+};
+
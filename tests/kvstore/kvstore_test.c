@@ -0,0 +1,352 @@
+/*
+ * Host test of the key/value store, over the file backed NVM stand-in
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// standard includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// tested module
+#include "KvStore.h"
+
+// for the NVM stand-in
+#include "nvm_file.h"
+
+/// Number of keys used by the tests
+#define TEST_KEYS (6)
+
+/// Check a condition, the test stops at the first failure
+#define CHECK(__c) do {                                                     \
+    if (!(__c)) {                                                           \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #__c); \
+        exit(1);                                                            \
+    }                                                                       \
+} while (0)
+
+/// File holding the flash
+static char const *test_path;
+
+/// Values expected in the store, 0 if the key has no value
+static uint32_t test_values[TEST_KEYS];
+
+/// Context resumed upon power failure
+static jmp_buf test_env;
+
+/**
+ * Restart the device: the flash is reloaded from the file and the store initialized.
+ */
+static void
+TestReboot(void)
+{
+    nvmType_t type;
+
+    NvmFileClose();
+    NvmFileOpen(test_path);
+    CHECK(NVM_Detect(gNvmInternalInterface_c, &type) == gNvmErrNoError_c);
+    CHECK(KvInit(type) == KV_OK);
+}
+
+/**
+ * Read a key.
+ * @param[in] key Key to read
+ * @return The value, 0 if the key has no value
+ */
+static uint32_t
+TestGet(uint8_t key)
+{
+    uint32_t value = 0;
+    uint8_t len = sizeof(value);
+    kvErr_t err;
+
+    err = KvGet(key, &value, &len);
+    if (err == KV_ERR_NOT_FOUND)
+    {
+        return 0;
+    }
+    CHECK(err == KV_OK);
+    CHECK(len == sizeof(value));
+    return value;
+}
+
+/**
+ * Write a key and remember its value.
+ * @param[in] key Key to write
+ * @param[in] value Value, 0 deletes the key
+ */
+static void
+TestSet(uint8_t key, uint32_t value)
+{
+    if (value)
+    {
+        CHECK(KvSet(key, &value, sizeof(value)) == KV_OK);
+    }
+    else
+    {
+        CHECK(KvDelete(key) == KV_OK);
+    }
+    test_values[key] = value;
+}
+
+/**
+ * Check that the store holds the expected values.
+ */
+static void
+TestVerify(void)
+{
+    uint8_t key;
+
+    for (key = 0; key < TEST_KEYS; key++)
+    {
+        CHECK(TestGet(key) == test_values[key]);
+    }
+}
+
+/**
+ * Save the content of the flash.
+ * @param[out] image Buffer receiving the content
+ */
+static void
+TestSave(uint8_t *image)
+{
+    CHECK(NVM_Read(gNvmInternalInterface_c, gNvmType_SST_c, image, 0,
+            NVM_FILE_SIZE - NVM_FILE_SECTOR) == gNvmErrNoError_c);
+}
+
+/**
+ * Restore the content of the flash saved by TestSave and reboot.
+ * @param[in] image Content to restore
+ */
+static void
+TestRestore(uint8_t const *image)
+{
+    uint8_t s;
+
+    for (s = 0; s < (NVM_FILE_SECTORS - 1); s++)
+    {
+        CHECK(NVM_Erase(gNvmInternalInterface_c, gNvmType_SST_c, 1 << s) == gNvmErrNoError_c);
+    }
+    CHECK(NVM_Write(gNvmInternalInterface_c, gNvmType_SST_c, (void *)image, 0,
+            NVM_FILE_SIZE - NVM_FILE_SECTOR) == gNvmErrNoError_c);
+    TestReboot();
+}
+
+/**
+ * Blank flash, values written, deleted and read back after a reboot.
+ */
+static void
+TestBasic(void)
+{
+    uint8_t value[KV_VALUE_MAX + 1];
+    uint8_t len;
+    uint8_t key;
+
+    TestVerify();
+    CHECK(KvGet(KV_KEY_NUM, value, &len) == KV_ERR_INVALID);
+    CHECK(KvSet(0, value, 0) == KV_ERR_INVALID);
+    CHECK(KvSet(0, value, KV_VALUE_MAX + 1) == KV_ERR_INVALID);
+
+    for (key = 0; key < TEST_KEYS; key++)
+    {
+        TestSet(key, 0x1000 + key);
+    }
+    TestSet(2, 0);
+    TestSet(3, 0x3333);
+    TestVerify();
+
+    TestReboot();
+    TestVerify();
+
+    // a shorter buffer gets the beginning of the value
+    len = 2;
+    CHECK(KvGet(3, value, &len) == KV_OK);
+    CHECK((len == 2) && (value[0] == 0x33) && (value[1] == 0x33));
+
+    // an unchanged value is not written again
+    len = NvmFileStats()->written;
+    TestSet(3, 0x3333);
+    CHECK(NvmFileStats()->written == len);
+
+    printf("basic: ok\n");
+}
+
+/**
+ * Many writes: the store moves to the next sector in turn and the erases are spread
+ * over its sectors.
+ */
+static void
+TestRotation(void)
+{
+    struct nvm_file_stats const *stats = NvmFileStats();
+    uint32_t first[KV_SECTOR_NUM], i, min, max;
+    uint8_t s;
+
+    for (s = 0; s < KV_SECTOR_NUM; s++)
+    {
+        first[s] = stats->erases[KV_SECTOR_FIRST + s];
+    }
+
+    for (i = 1; i <= 20000; i++)
+    {
+        TestSet(i % TEST_KEYS, i);
+        if (!(i % 997))
+        {
+            TestReboot();
+            TestVerify();
+        }
+    }
+    TestVerify();
+
+    // only the sectors of the store are erased, evenly
+    min = 0xFFFFFFFF;
+    max = 0;
+    for (s = 0; s < NVM_FILE_SECTORS; s++)
+    {
+        if ((s >= KV_SECTOR_FIRST) && (s < (KV_SECTOR_FIRST + KV_SECTOR_NUM)))
+        {
+            i = stats->erases[s] - first[s - KV_SECTOR_FIRST];
+            min = (i < min) ? i : min;
+            max = (i > max) ? i : max;
+        }
+        else
+        {
+            CHECK(stats->erases[s] == 0);
+        }
+    }
+    CHECK(min > 10);
+    CHECK((max - min) <= 1);
+
+    printf("rotation: ok, %u to %u erases per sector\n", min, max);
+}
+
+/**
+ * Power failure at every byte of a write, the key keeps its previous value or gets
+ * the new one and the other keys are untouched.
+ * @param[in] key Key written
+ * @param[in] value Value written
+ * @return Number of bytes programmed or erased by the write
+ */
+static uint32_t
+TestPowerFail(uint8_t key, uint32_t value)
+{
+    static uint8_t image[NVM_FILE_SIZE];
+    uint32_t bytes, old = test_values[key];
+    volatile uint32_t n;
+    uint32_t got;
+
+    TestSave(image);
+    for (n = 0; ; n++)
+    {
+        TestRestore(image);
+
+        if (setjmp(test_env))
+        {
+            // the power failed: reboot and check
+            NvmFileFailNever();
+            TestReboot();
+
+            got = TestGet(key);
+            CHECK((got == old) || (got == value));
+            test_values[key] = got;
+            TestVerify();
+
+            // the store is still usable
+            TestSet(key, value + 1);
+            TestReboot();
+            TestVerify();
+            test_values[key] = old;
+            continue;
+        }
+
+        NvmFileFailAfter(n, &test_env);
+        TestSet(key, value);
+        NvmFileFailNever();
+        break;
+    }
+
+    bytes = n;
+    TestReboot();
+    TestVerify();
+    return bytes;
+}
+
+/**
+ * Power failures during a simple write, then during a write moving the store to the
+ * next sector.
+ */
+static void
+TestCommit(void)
+{
+    static uint8_t image[NVM_FILE_SIZE];
+    uint32_t bytes, before, old, i;
+    uint8_t s;
+
+    bytes = TestPowerFail(1, 0xCAFE0001);
+    printf("power failure: ok, %u failure points in a record write\n", bytes);
+
+    // fill the active sector, up to the write that needs the next one
+    for (i = 0; ; i++)
+    {
+        TestSave(image);
+        old = test_values[4];
+        for (before = 0, s = 0; s < KV_SECTOR_NUM; s++)
+        {
+            before += NvmFileStats()->erases[KV_SECTOR_FIRST + s];
+        }
+
+        TestSet(4, 0x4000 + i);
+        for (s = 0; s < KV_SECTOR_NUM; s++)
+        {
+            before -= NvmFileStats()->erases[KV_SECTOR_FIRST + s];
+        }
+        if (before)
+        {
+            break;
+        }
+    }
+    test_values[4] = old;
+    TestRestore(image);
+
+    // the same write on another key compacts the store too
+    bytes = TestPowerFail(5, 0xCAFE0005);
+    CHECK(bytes > KV_SECTOR_SIZE);
+    printf("power failure: ok, %u failure points in a compaction\n", bytes);
+}
+
+int
+main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s flash_file\n", argv[0]);
+        return 1;
+    }
+    test_path = argv[1];
+
+    // start from a blank flash
+    remove(test_path);
+    NvmFileOpen(test_path);
+    TestReboot();
+
+    TestBasic();
+    TestRotation();
+    TestCommit();
+
+    NvmFileClose();
+    return 0;
+}
@@ -0,0 +1,234 @@
+/*
+ * File backed stand-in of the NVM driver implementation
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// standard includes
+#include <stdio.h>
+#include <stdlib.h>
+
+// minimum include
+#include "nvm_file.h"
+
+/// Stand-in environment
+static struct nvm_file_env
+{
+    /// File holding the flash
+    FILE *file;
+
+    /// Copy of the flash
+    uint8_t data[NVM_FILE_SIZE];
+
+    /// Bytes left before the power failure, when armed
+    uint32_t budget;
+
+    /// Context resumed upon power failure, NULL if not armed
+    jmp_buf *env;
+
+    /// Access counters
+    struct nvm_file_stats stats;
+} nvm_file_env;
+
+/**
+ * Store a range of the copy into the file.
+ * @param[in] addr First address
+ * @param[in] len Length of the range
+ */
+static void
+NvmFileSync(uint32_t addr, uint32_t len)
+{
+    if (fseek(nvm_file_env.file, addr, SEEK_SET) ||
+        (fwrite(&nvm_file_env.data[addr], 1, len, nvm_file_env.file) != len) ||
+        fflush(nvm_file_env.file))
+    {
+        perror("nvm file");
+        exit(1);
+    }
+}
+
+/**
+ * Take a byte from the power budget, the flash is stored in the file when the power
+ * fails.
+ */
+static void
+NvmFileSpend(void)
+{
+    if (!nvm_file_env.env)
+    {
+        return;
+    }
+    if (nvm_file_env.budget--)
+    {
+        return;
+    }
+
+    // the power fails in the middle of the byte: only some of its bits changed
+    NvmFileSync(0, NVM_FILE_SIZE);
+    longjmp(*nvm_file_env.env, 1);
+}
+
+void
+NvmFileOpen(char const *path)
+{
+    uint32_t i;
+
+    nvm_file_env.file = fopen(path, "r+b");
+    if (!nvm_file_env.file)
+    {
+        // blank flash
+        nvm_file_env.file = fopen(path, "w+b");
+        if (!nvm_file_env.file)
+        {
+            perror(path);
+            exit(1);
+        }
+        for (i = 0; i < NVM_FILE_SIZE; i++)
+        {
+            nvm_file_env.data[i] = 0xFF;
+        }
+        NvmFileSync(0, NVM_FILE_SIZE);
+    }
+    else if (fread(nvm_file_env.data, 1, NVM_FILE_SIZE, nvm_file_env.file) != NVM_FILE_SIZE)
+    {
+        fprintf(stderr, "%s: not a flash image\n", path);
+        exit(1);
+    }
+
+    nvm_file_env.env = NULL;
+}
+
+void
+NvmFileClose(void)
+{
+    fclose(nvm_file_env.file);
+    nvm_file_env.file = NULL;
+}
+
+void
+NvmFileFailAfter(uint32_t bytes, jmp_buf *env)
+{
+    nvm_file_env.budget = bytes;
+    nvm_file_env.env = env;
+}
+
+void
+NvmFileFailNever(void)
+{
+    nvm_file_env.env = NULL;
+}
+
+struct nvm_file_stats const *
+NvmFileStats(void)
+{
+    return &nvm_file_env.stats;
+}
+
+nvmErr_t
+NVM_Detect(nvmInterface_t nvmInterface, nvmType_t *pNvmType)
+{
+    if (nvmInterface != gNvmInternalInterface_c)
+    {
+        return gNvmErrInvalidInterface_c;
+    }
+    *pNvmType = gNvmType_SST_c;
+    return gNvmErrNoError_c;
+}
+
+nvmErr_t
+NVM_Read(nvmInterface_t nvmInterface, nvmType_t nvmType, void *pDest, uint32_t address,
+        uint32_t numBytes)
+{
+    uint32_t i;
+
+    if (nvmInterface != gNvmInternalInterface_c)
+    {
+        return gNvmErrInvalidInterface_c;
+    }
+    // the last sector is reserved
+    if ((address + numBytes) > (NVM_FILE_SIZE - NVM_FILE_SECTOR))
+    {
+        return gNvmErrRestrictedArea_c;
+    }
+
+    for (i = 0; i < numBytes; i++)
+    {
+        ((uint8_t *)pDest)[i] = nvm_file_env.data[address + i];
+    }
+    return gNvmErrNoError_c;
+}
+
+nvmErr_t
+NVM_Write(nvmInterface_t nvmInterface, nvmType_t nvmType, void *pSrc, uint32_t address,
+        uint32_t numBytes)
+{
+    uint8_t const *src = pSrc;
+    uint32_t i;
+
+    if (nvmInterface != gNvmInternalInterface_c)
+    {
+        return gNvmErrInvalidInterface_c;
+    }
+    if ((address + numBytes) > (NVM_FILE_SIZE - NVM_FILE_SECTOR))
+    {
+        return gNvmErrRestrictedArea_c;
+    }
+
+    for (i = 0; i < numBytes; i++)
+    {
+        // programming only clears bits, half of them when the power fails
+        nvm_file_env.data[address + i] &= src[i] | 0x0F;
+        NvmFileSpend();
+        nvm_file_env.data[address + i] &= src[i];
+        nvm_file_env.stats.written++;
+    }
+    NvmFileSync(address, numBytes);
+    return gNvmErrNoError_c;
+}
+
+nvmErr_t
+NVM_Erase(nvmInterface_t nvmInterface, nvmType_t nvmType, uint32_t sectorBitfield)
+{
+    uint32_t s, i, addr;
+
+    if (nvmInterface != gNvmInternalInterface_c)
+    {
+        return gNvmErrInvalidInterface_c;
+    }
+
+    for (s = 0; s < NVM_FILE_SECTORS; s++)
+    {
+        if (!(sectorBitfield & (1 << s)))
+        {
+            continue;
+        }
+        if (s == (NVM_FILE_SECTORS - 1))
+        {
+            return gNvmErrRestrictedArea_c;
+        }
+
+        addr = s * NVM_FILE_SECTOR;
+        nvm_file_env.stats.erases[s]++;
+        for (i = 0; i < NVM_FILE_SECTOR; i++)
+        {
+            // an interrupted erase leaves the sector partially erased
+            NvmFileSpend();
+            nvm_file_env.data[addr + i] = 0xFF;
+        }
+        NvmFileSync(addr, NVM_FILE_SECTOR);
+    }
+    return gNvmErrNoError_c;
+}
@@ -0,0 +1,88 @@
+/*
+ * File backed stand-in of the internal flash NVM driver, for the host tests
+ *
+ * The flash is a file of NVM_FILE_SIZE bytes.  The writes can only clear bits, as on
+ * the real flash, and the erase sets whole sectors back to 0xFF.  A power failure can
+ * be armed to stop the writes after a number of bytes.
+ *
+ *    Copyright (C) 2009 Louis Caron
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _NVM_FILE_H_
+#define _NVM_FILE_H_
+
+// standard includes
+#include <stdint.h>
+#include <setjmp.h>
+
+// for the NVM API
+#include "NVM.h"
+
+/// Size of the internal flash
+#define NVM_FILE_SIZE   (0x20000)
+
+/// Size of a sector
+#define NVM_FILE_SECTOR (0x1000)
+
+/// Number of sectors
+#define NVM_FILE_SECTORS (NVM_FILE_SIZE / NVM_FILE_SECTOR)
+
+/// Access counters
+struct nvm_file_stats
+{
+    /// Number of erases of each sector
+    uint32_t erases[NVM_FILE_SECTORS];
+
+    /// Number of bytes written
+    uint32_t written;
+};
+
+/**
+ * Open the file holding the flash, it is created erased if it does not exist.
+ * @param[in] path Path of the file
+ */
+extern void
+NvmFileOpen(char const *path);
+
+/**
+ * Close the file, the content stays for the next NvmFileOpen.
+ */
+extern void
+NvmFileClose(void);
+
+/**
+ * Arm a power failure: the writes and erases stop after a number of bytes, the last
+ * byte being partially programmed, then the execution resumes at the setjmp of env.
+ * @param[in] bytes Number of bytes written before the failure
+ * @param[in] env Context to resume
+ */
+extern void
+NvmFileFailAfter(uint32_t bytes, jmp_buf *env);
+
+/**
+ * Disarm the power failure.
+ */
+extern void
+NvmFileFailNever(void);
+
+/**
+ * Get the access counters.
+ * @return The counters since the start of the test, the reboots included
+ */
+extern struct nvm_file_stats const *
+NvmFileStats(void);
+
+#endif // _NVM_FILE_H_
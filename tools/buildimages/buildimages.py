@@ -9,11 +9,12 @@ import sys
 import os
 import getopt
 import struct
+import zlib
 import common.bytes
 
 usage_doc ="""
 Synopsis:
-    buildimages.py [-v|--verbose] [-h|--help] [-o radix] elffile
+    buildimages.py [-v|--verbose] [-h|--help] [-s|--sparse] [-o radix] elffile
 
        -h
        --help: self explanatory
@@ -22,9 +23,44 @@ Synopsis:
        -o radix: radix of the output images name, defaults to 'image',
                  generating image_ram.bin and image_flash.bin
                  if radix is foo -> generate foo_ram.bin and foo_flash.bin
+       -s
+       --sparse: also generate the segment table image radix_sparse.bin
        elffile : ELF object file containing the loadable to generate images for
+
+Segment table image format (all fields are little endian 32-bit words):
+    "SEGT" | length of what follows | entry | number of segments |
+    number of flash records | segments... | flash records...
+    each segment (in increasing addresses):
+        address | file size | memory size | file size bytes of data (padded to 4)
+    each flash record (in increasing addresses, after the segments):
+        address in the flash | size | size | size bytes of data (padded to 4)
+    The gaps between the segments and the (memory size - file size) tails are not
+    part of the image.  The ROM does not boot it: the flasher application places the
+    data of the segments in the flash image and fills the rest with 0's, then writes
+    the flash records after the image, so that the flash holds radix_flash.bin without
+    its padding being sent (make <target>_flash_sparse).  The overlay table and data
+    are the flash record.
+
+Overlays (OVL_n sections of RAMROM.lds, load address different from their address):
+    They are not part of the RAM image, and are a flash record of the segment table
+    image.  The flash image is followed (from the next word) by their table, read by
+    Overlay.c:
+    "OVLY" | number of overlays | build ID | overlays...
+    the build ID is the CRC32 of the EXEC_RAM_TEXT section (resident code and
+    constants), checked against the running image
+    each overlay (n = 0 to number - 1, size 0 if OVL_n is empty):
+        address | size | address in the flash | CRC32 of the data
+    then the data of the overlays (each one padded to 4).
 """
 
+# first word of the segment table image, distinct from the "OKOK" of the flash image so
+# that it is never booted as a RAM image
+SPARSE_MAGIC = "SEGT"
+# prefix of the overlay sections, followed by their number
+OVERLAY_PREFIX = "OVL_"
+# section of the resident code and constants, its CRC32 is the build ID of the overlays
+BUILD_ID_SECTION = "EXEC_RAM_TEXT"
+
 def usage():
     print usage_doc
 
@@ -33,10 +69,12 @@ def main():
     verbose = False
     # default radix
     radix = "image"
+    # by default, do not generate the segment table image
+    sparse = False
 
     # parse the command line
     try:
-        opts, args = getopt.getopt(sys.argv[1:], "vho:", ["help", "verbose"])
+        opts, args = getopt.getopt(sys.argv[1:], "vhso:", ["help", "verbose", "sparse"])
     except getopt.GetoptError:
         print("Unsupported option")
         # print help information and exit:
@@ -51,6 +89,8 @@ def main():
             radix = a
         if o == "-v" or o == "--verbose":
             verbose = True
+        if o == "-s" or o == "--sparse":
+            sparse = True
 
     # sanity check
     if len(args) != 1:
@@ -97,9 +137,32 @@ def main():
         print("ELF object file does not contain any program header")
         sys.exit(-1)
     
+    # find the overlay sections: {number: (address, data)}, and the build ID
+    overlays = {}
+    buildid = 0
+    shoff = struct.unpack("<L", content[32:36])[0]
+    shentsize = struct.unpack("<H", content[46:48])[0]
+    shnum = struct.unpack("<H", content[48:50])[0]
+    shstrndx = struct.unpack("<H", content[50:52])[0]
+    if shnum:
+        sh = content[shoff+(shstrndx*shentsize):shoff+((shstrndx+1)*shentsize)]
+        stroffset = struct.unpack("<LLLLLL", sh[:24])[4]
+    for i in range(shnum):
+        sh = content[shoff+(i*shentsize):shoff+((i+1)*shentsize)]
+        (name, type, flags, addr, offset, size) = struct.unpack("<LLLLLL", sh[:24])
+        name = content[stroffset+name:content.index("\0", stroffset+name)]
+        if name.startswith(OVERLAY_PREFIX) and size:
+            overlays[int(name[len(OVERLAY_PREFIX):])] = (addr, content[offset:offset+size])
+            if verbose:
+                print("Overlay %s: Start=0x%08X, Size=0x%X"%(name, addr, size))
+        if name == BUILD_ID_SECTION:
+            buildid = zlib.crc32(content[offset:offset+size]) & 0xFFFFFFFF
+
     # initialize the current segment address
     curraddr = 0x400000
     code = ""
+    # list of the loadable segments for the segment table image
+    segments = []
     
     # loop on all the program headers
     for i in range(phnum):
@@ -110,8 +173,11 @@ def main():
             
         # unpack header
         (type, offset, vaddr, paddr, filesz, memsz) = struct.unpack("LLLLLL", ph[:24])
-        # check if this is a loadable segment
-        if type == 1:
+        # check if this is a loadable segment, the overlays are added to the flash image
+        if type == 1 and paddr != vaddr:
+            if verbose:
+                print("  -> overlay, loaded from 0x%08X"%(paddr, ))
+        elif type == 1:
             if verbose:
                 print("    -> Last segment end=0x%08X, Segment: Start=0x%08X, File Size=0x%X, MemSize=0x%X)"
                       %(curraddr, vaddr, filesz, memsz))
@@ -126,6 +192,8 @@ def main():
             code += content[offset:offset+filesz]
             #    + pad with 0's after the binary
             code += "\0"*(memsz-filesz)
+            # keep the segment for the segment table image (no padding at all)
+            segments.append((vaddr, content[offset:offset+filesz], memsz))
             # update last segment end
             curraddr = vaddr + memsz
         else:
@@ -133,9 +201,28 @@ def main():
                 print("  -> not loadable program")
 
     
+    # the overlay table starts at the next word after the image, the data follows the
+    # table
+    flash = (8 + len(code) + 3) & ~3
+    ovlblob = ""
+    if overlays:
+        count = max(overlays.keys()) + 1
+        table = "OVLY" + struct.pack("<LL", count, buildid)
+        data = ""
+        addr = flash + len(table) + 16 * count
+        for n in range(count):
+            (vaddr, ovl) = overlays.get(n, (0, ""))
+            table += struct.pack("<LLLL", vaddr, len(ovl), addr + len(data),
+                                 zlib.crc32(ovl) & 0xFFFFFFFF)
+            data += ovl + "\0"*(-len(ovl) & 3)
+        ovlblob = table + data
+        print("... %d overlays: %d bytes, build ID 0x%08X"%(len(overlays), len(data), buildid))
+
     # generate the flash file
     fid = open(radix+"_flash.bin", 'wb')
     fid.write("OKOK"+struct.pack("L", len(code))+code)
+    if ovlblob:
+        fid.write("\0"*(flash - 8 - len(code)) + ovlblob)
     fid.close()
 
     print("... generated '%s': %d bytes"%(fid.name, os.stat(fid.name).st_size))
@@ -146,6 +233,27 @@ def main():
     fid.close()
     print("... generated '%s': %d bytes"%(fid.name, os.stat(fid.name).st_size))
 
+    if sparse:
+        # generate the segment table file, the overlays are a flash record
+        records = [(flash, ovlblob)] if ovlblob else []
+        table = struct.pack("<LLL", entry, len(segments), len(records))
+        for (vaddr, data, memsz) in segments:
+            if verbose:
+                print("Segment: Start=0x%08X, File Size=0x%X, Zero Fill=0x%X"
+                      %(vaddr, len(data), memsz-len(data)))
+            table += struct.pack("<LLL", vaddr, len(data), memsz)
+            # keep the next record word aligned
+            table += data + "\0"*(-len(data) & 3)
+        for (addr, data) in records:
+            if verbose:
+                print("Flash record: Start=0x%08X, Size=0x%X"%(addr, len(data)))
+            table += struct.pack("<LLL", addr, len(data), len(data))
+            table += data + "\0"*(-len(data) & 3)
+        fid = open(radix+"_sparse.bin", 'wb')
+        fid.write(SPARSE_MAGIC+struct.pack("<L", len(table))+table)
+        fid.close()
+        print("... generated '%s': %d bytes"%(fid.name, os.stat(fid.name).st_size))
+
 # main execution
 if __name__ == '__main__':
     main()
@@ -19,24 +19,80 @@ import sys
 import getopt
 import serial
 import struct
+import zlib
 
 import common.legalexception
 
+# size of the pages written by the flasher application (FLASHER_PAGE_SIZE in flasher.c)
+FLASHER_PAGE_SIZE = 256
+# end of the flash image, the persistent store follows (FLASHER_IMAGE_END in flasher.c)
+FLASHER_IMAGE_END = 0x1C000
+
 def usage():
     print """
-usage: loaduart.py [-h|--help] [-v] [-c numport] [-b baudrate] [-n] file1 file2 ...
+usage: loaduart.py [-h|--help] [-v] [-c numport] [-b baudrate] [-n] [-d addr:len:file] file1 file2 ...
        -h --help: print this help
        -v: verbose option
        -c numport: com port number (default is COM1)
        -b baudrate: baudrate (default is 115200)
        -n: do not wait for the CONNECT keyword
-       file1 file2 ... : list of files to load (first is expected to be from BOOTLOADER flow)
+       -d addr:len:file: once the files are loaded, request a binary dump of the NVM range
+          to the dumpflash application and save it to file
+       file1 file2 ... : list of files to load (first is expected to be from BOOTLOADER flow,
+          the next ones can be flash images or segment table images for the flasher)
+    """
+
+def readuntil(ser, keyword):
+    """Read the serial port until a keyword is received, print what was received"""
+    response = ""
+    while not response.endswith(keyword):
+        c = ser.read(1)
+        sys.stdout.write(c)
+        response += c
+    return response
+
+def dump(ser, addr, length, filename):
+    """Request a binary dump to the dumpflash application and save it to a file
+
+    The application answers to the command 'b' <addr> <len> with the length actually
+    dumped in hexadecimal, the raw data, the CRC32 of the data and the NVM read status.
+    The dump fails if a part of the range could not be read (sent as 0xFF).
     """
+    readuntil(ser, "ready...\n")
+    ser.write("b" + struct.pack("<LL", addr, length))
+    requested = length
+    length = int(readuntil(ser, "\n").strip(), 16)
+    if length != requested:
+        print("Warning: range clipped to the readable NVM (0x%X bytes requested)" % requested)
+    print("Receiving 0x%X bytes from 0x%X" % (length, addr))
+
+    data = ""
+    while len(data) < length + 4:
+        received = ser.read(length + 4 - len(data))
+        if received == "":
+            raise common.legalexception.LegalException("Dump timed out after %d bytes" % len(data), 0)
+        sys.stdout.write(". "*((len(data)+len(received))/1024 - len(data)/1024))
+        data += received
+    print("")
+
+    crc = struct.unpack("<L", data[length:])[0]
+    data = data[:length]
+    if crc != (zlib.crc32(data) & 0xFFFFFFFF):
+        raise common.legalexception.LegalException("Dump CRC error", 0)
+
+    fid = open(filename, "wb")
+    fid.write(data)
+    fid.close()
+    print("Dump saved to: %s" % filename)
+
+    status = readuntil(ser, "\n").strip()
+    if int(status.split("0x")[-1], 16):
+        raise common.legalexception.LegalException("NVM read error, the unread bytes are 0xFF (%s)" % status, 0)
 
 def main():
     # parse the command line
     try:
-        opts, args = getopt.getopt(sys.argv[1:], "hvnpc:b:", ["help", ])
+        opts, args = getopt.getopt(sys.argv[1:], "hvnpc:b:d:", ["help", ])
     except getopt.GetoptError:
         # print help information and exit:
         usage()
@@ -47,6 +103,7 @@ def main():
     comport = 0
     baudrate = 115200
     connected = False
+    dumprange = None
     for o, a in opts:
         if o in ["--help", "-h"]:
             usage()
@@ -67,6 +124,12 @@ def main():
                 baudrate = int(a, 0)
             except:
                 raise common.legalexception.LegalException("Impossible to parse baudrate", 0)
+        if o == "-d":
+            try:
+                addr, length, filename = a.split(":", 2)
+                dumprange = (int(addr, 0), int(length, 0), filename)
+            except:
+                raise common.legalexception.LegalException("Impossible to parse dump range", 0)
 
     try:
         # create a serial port instance:
@@ -99,6 +162,15 @@ def main():
             fid.close()
             print("Processing file: %s(%d)"%(f, len(data)))
 
+            # a segment table image (buildimages.py --sparse) is placed by the flasher,
+            # the ROM would not boot it
+            if f == args[0] and data[0:4] == "SEGT":
+                raise common.legalexception.LegalException("Segment table image %s can only be sent to the flasher" % f, 0)
+
+            # the flasher rejects the images overlapping the persistent store
+            if f != args[0] and len(data) > FLASHER_IMAGE_END:
+                raise common.legalexception.LegalException("Image %s is longer than the flash image area (0x%X bytes)" % (f, FLASHER_IMAGE_END), 0)
+
             # write the length of the file to the UART
             ser.write(struct.pack("<L", len(data)))
 
@@ -106,24 +178,35 @@ def main():
             if f == args[0]:
                 ser.write(data)
             else:
-                counter = 0
-                while data != "":
-                    if len(data) > 32:
-                        sent = data[0:32]
-                        data = data[32:]
-                    else:
-                        sent = data
-                        data = ""
-                    # send a bunch of chars
-                    ser.write(sent)
-                    # wait for the acknowledgment
-                    ack = ser.read(len(sent))
-                    if sent != ack:
-                        print("ERROR: Character sent and acknowledged differ")
+                # the flasher acknowledges each page with its status and the CRC32 of
+                # the page received, there are up to 2 pages in flight so that a page is
+                # received while the previous one is written to the flash
+                pages = [data[i:i+FLASHER_PAGE_SIZE] for i in range(0, len(data), FLASHER_PAGE_SIZE)]
+                sent = 0
+                acked = 0
+                while acked < len(pages):
+                    while (sent < len(pages)) and (sent - acked < 2):
+                        ser.write(pages[sent])
+                        sent += 1
+                    # wait for the acknowledgment of the oldest page
+                    ack = ""
+                    retries = 0
+                    while len(ack) < 5:
+                        received = ser.read(5 - len(ack))
+                        ack += received
+                        retries = (retries + 1) if received == "" else 0
+                        if retries > 40:
+                            print("ERROR: No acknowledgment for page %d" % acked)
+                            sys.exit(-1)
+                    status, crc = struct.unpack("<BL", ack)
+                    if status != 0:
+                        print("ERROR: Flash write of page %d returned 0x%02X" % (acked, status))
                         sys.exit(-1)
-                    # increment the number of chars sent
-                    counter+=len(sent)
-                    sys.stdout.write(". "*((counter+len(sent))/100 - (counter/100)))
+                    if crc != (zlib.crc32(pages[acked]) & 0xFFFFFFFF):
+                        print("ERROR: Page %d sent and acknowledged differ" % acked)
+                        sys.exit(-1)
+                    acked += 1
+                    sys.stdout.write(". ")
 
             # if this is the last file of the list, just leave 
             if f == args[-1]:
@@ -137,6 +220,13 @@ def main():
                 # wait for an indication from user
                 indication = raw_input("press 'n' for next download -->")
 
+        if dumprange:
+            # the timeout is only used to detect a stalled transfer
+            ser.timeout = 2
+            dump(ser, *dumprange)
+            ser.close()
+            return
+
         print("Finished loading files -> monitoring UART")
         while (True):
             # read the maximum amount of characters
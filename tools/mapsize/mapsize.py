@@ -0,0 +1,252 @@
+########################################################################################
+# Report the footprint of an image from the GNU ld map file
+#
+# Copyright (C) 2009 Louis Caron
+#
+########################################################################################
+
+import sys
+import os
+import getopt
+import re
+
+usage_doc ="""
+Synopsis:
+    mapsize.py [-h|--help] [-d|--detail section]... [-m|--modules] [-b|--budget bytes]
+               mapfile...
+
+       -h
+       --help: self explanatory
+       -d section
+       --detail section: also list the size of each object in the output section,
+                 can be repeated, defaults to EXEC_RAM_FUNC (the __RAMFUNC code)
+                 when -m is not given
+       -m
+       --modules: list the text (code and constants), data and bss of each object
+       -b bytes
+       --budget bytes: fail if the image (from the start of the SRAM to the end of
+                 the BSS, the heap and stacks excluded) is larger than bytes
+       mapfile : map file generated by the linker (-Map), when several are given the
+                 sizes are shown side by side to compare the build profiles
+"""
+
+# output section: name at the start of the line, address and size may be wrapped
+re_output = re.compile(r"^([A-Za-z_.][\w.]*)\s*(?:(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+))?\s*$")
+# input section: indented name, address and size may be wrapped, then the object
+re_input = re.compile(r"^ (\.?[\w.]+|COMMON)\s*(?:(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(.*))?$")
+# wrapped address and size
+re_wrapped = re.compile(r"^\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s*(.*)$")
+
+# columns of the modules table
+TEXT = 0
+DATA = 1
+BSS = 2
+
+def usage():
+    print(usage_doc)
+
+def kind(name):
+    """ return the column of an input section """
+    if name.startswith(".bss") or name == "COMMON":
+        return BSS
+    if name.startswith(".data"):
+        return DATA
+    return TEXT
+
+def parse(lines):
+    """ return the list of (name, address, size, {object: size}) output sections, the
+        {object: [text, data, bss]} modules and the bytes removed by --gc-sections """
+    sections = []
+    modules = {}
+    discarded = 0
+    current = None
+    pending = None
+    part = None
+
+    def add(name, size, obj):
+        # the debug sections are not loaded (address 0)
+        if current is None or current[1] == 0 or not obj:
+            return
+        current[3][obj] = current[3].get(obj, 0) + size
+        modules.setdefault(obj, [0, 0, 0])[kind(name)] += size
+
+    def discard(name, size):
+        if not name.startswith(".debug") and not name.startswith(".comment"):
+            return size
+        return 0
+
+    for line in lines:
+        line = line.rstrip("\r\n")
+
+        # parts of the map file
+        if line.startswith("Discarded input sections"):
+            part = "discarded"
+            continue
+        if line.startswith("Memory Configuration"):
+            part = None
+            continue
+        if line.startswith("Linker script and memory map"):
+            part = "map"
+            continue
+        if part is None:
+            continue
+
+        # end of the name of an output or input section on the previous line
+        if pending is not None:
+            m = re_wrapped.match(line)
+            pending_kind, pending_name = pending
+            pending = None
+            if m:
+                addr, size, obj = int(m.group(1), 16), int(m.group(2), 16), m.group(3)
+                if pending_kind == "output":
+                    current = (pending_name, addr, size, {})
+                    sections.append(current)
+                elif part == "discarded":
+                    discarded += discard(pending_name, size)
+                else:
+                    add(pending_name, size, obj.strip())
+                continue
+
+        m = re_output.match(line)
+        if m and part == "map" and not line.startswith(" "):
+            if m.group(2) is None:
+                pending = ("output", m.group(1))
+            else:
+                current = (m.group(1), int(m.group(2), 16), int(m.group(3), 16), {})
+                sections.append(current)
+            continue
+
+        m = re_input.match(line)
+        if m:
+            if m.group(2) is None:
+                pending = ("input", m.group(1))
+            elif part == "discarded":
+                discarded += discard(m.group(1), int(m.group(3), 16))
+            elif m.group(4):
+                add(m.group(1), int(m.group(3), 16), m.group(4).strip())
+
+    return sections, modules, discarded
+
+def main():
+    details = []
+    show_modules = False
+    budget = None
+
+    # parse the command line
+    try:
+        opts, args = getopt.getopt(sys.argv[1:], "hd:mb:",
+                ["help", "detail=", "modules", "budget="])
+    except getopt.GetoptError:
+        print("Unsupported option")
+        # print help information and exit:
+        usage()
+        sys.exit(-1)
+
+    for o, a in opts:
+        if o == "--help" or o == "-h":
+            usage()
+            sys.exit(-1)
+        if o == "-d" or o == "--detail":
+            details.append(a)
+        if o == "-m" or o == "--modules":
+            show_modules = True
+        if o == "-b" or o == "--budget":
+            budget = int(a, 0)
+
+    # sanity check
+    if len(args) < 1:
+        print("Map file not provided (%s)"%(args,))
+        sys.exit(-1)
+
+    if not details and not show_modules:
+        details = ["EXEC_RAM_FUNC"]
+
+    maps = []
+    for mapfile in args:
+        try:
+            fid = open(mapfile, "r")
+            sections, modules, discarded = parse(fid.readlines())
+            fid.close()
+        except IOError:
+            print("Cannot read the map file %s"%(mapfile,))
+            sys.exit(-1)
+
+        # only the allocated sections, the debug ones are at address 0
+        sections = [s for s in sections if s[1] != 0 and s[2] != 0]
+        maps.append((sections, modules, discarded))
+
+    # sections in the order of the first map they appear in
+    names = []
+    for sections, modules, discarded in maps:
+        for s in sections:
+            if s[0] not in names:
+                names.append(s[0])
+
+    def find(sections, name):
+        for s in sections:
+            if s[0] == name:
+                return s
+        return None
+
+    names_map = [os.path.basename(m) for m in args]
+
+    # sizes of the output sections, and the address for a single map
+    if len(maps) == 1:
+        print("%-20s %10s %10s"%("section", "address", "size"))
+        for name, addr, size, objects in maps[0][0]:
+            print("%-20s 0x%08x %10d"%(name, addr, size))
+    else:
+        print("%-20s"%("section",) + "".join([" %16s"%(n[-16:],) for n in names_map]))
+        for name in names:
+            sizes = [find(m[0], name) for m in maps]
+            print("%-20s"%(name,) + "".join([" %16s"%(s and s[2] or "-",) for s in sizes]))
+
+    # size of the objects in the detailed sections
+    for name in names:
+        if name not in details:
+            continue
+        for mapname, (sections, modules, discarded) in zip(names_map, maps):
+            s = find(sections, name)
+            if s is None:
+                continue
+            print("\n%s (%s): %d bytes"%(name, mapname, s[2]))
+            for obj, osize in sorted(s[3].items(), key=lambda o: -o[1]):
+                if osize:
+                    print("    %6d %s"%(osize, os.path.basename(obj)))
+
+    # text, data and bss of the objects, largest first
+    if show_modules:
+        for mapname, (sections, modules, discarded) in zip(names_map, maps):
+            total = [0, 0, 0]
+            print("\n%s: %8s %8s %8s  module"%(mapname, "text", "data", "bss"))
+            for obj, sizes in sorted(modules.items(), key=lambda o: -sum(o[1])):
+                print("%s  %8d %8d %8d  %s"%(" " * len(mapname), sizes[TEXT], sizes[DATA],
+                        sizes[BSS], os.path.basename(obj)))
+                total = [t + s for t, s in zip(total, sizes)]
+            print("%s  %8d %8d %8d  total"%(" " * len(mapname), total[TEXT], total[DATA],
+                    total[BSS]))
+            if discarded:
+                print("%s  %d bytes removed by --gc-sections"%(" " * len(mapname), discarded))
+
+    # image size against the budget
+    failed = False
+    for mapname, (sections, modules, discarded) in zip(names_map, maps):
+        image = [s for s in sections if not s[0].startswith("RAM_STACK")]
+        if not image:
+            continue
+        used = max([s[1] + s[2] for s in image]) - min([s[1] for s in image])
+        if budget is None:
+            print("\n%s: image %d bytes"%(mapname, used))
+        elif used > budget:
+            print("\n%s: image %d bytes, SRAM budget of %d bytes exceeded by %d bytes"%(
+                    mapname, used, budget, used - budget))
+            failed = True
+        else:
+            print("\n%s: image %d bytes, %d bytes left in the SRAM budget"%(
+                    mapname, used, budget - used))
+
+    if failed:
+        sys.exit(1)
+
+if __name__ == "__main__":
+    main()